@@ -8,6 +8,9 @@
 #include "ns3/flow-monitor-module.h"
 #include "ns3/flow-monitor-helper.h"
 #include "ns3/packet-sink.h"
+
+#include "../binary-trace.h"
+
 #include <iostream>
 
 using namespace ns3;
@@ -19,10 +22,9 @@ std::map<Ipv4Address, double> endTime;
 std::map<Ipv4Address, uint64_t> bytesReceived;
 
 
-void TotalRx(Ptr<OutputStreamWrapper> stream, Ipv4Address clientAddress, Ptr<const Packet> packet, const Address &from)
+void TotalRx(Ptr<BinaryTraceWriter> trace, uint32_t node, uint32_t context, Ipv4Address clientAddress, Ptr<const Packet> packet, const Address &from)
 {
     double now = Simulator::Now().GetSeconds();
-    std::cout << "TotalRx called for client " << clientAddress << " at time " << now << std::endl;
 
     // Initialize start time and bytes received for this client
     if (startTime.find(clientAddress) == startTime.end()) {
@@ -42,8 +44,9 @@ void TotalRx(Ptr<OutputStreamWrapper> stream, Ipv4Address clientAddress, Ptr<con
 
         double completionTime = endTime[clientAddress] - startTime[clientAddress];
 
-        // Output the completion time for this client
-        *stream->GetStream() << "Client " << clientAddress << " completion time: " << completionTime << " seconds" << std::endl;
+        // Completion event for this client, completion time in microseconds as aux
+        trace->Write(TraceEvent::Completion, node, 0, bytesReceived[clientAddress], clientAddress.Get(), context,
+                     static_cast<uint32_t>(completionTime * 1e6));
     }
 }
 
@@ -163,22 +166,22 @@ int main (int argc, char *argv[])
 	sinkApps.Stop(Seconds(simulationTime));
 
 
-	AsciiTraceHelper ascii;
-	Ptr<OutputStreamWrapper> stream = ascii.CreateFileStream("wifi-download-completion-times.tr");
-	if (stream->GetStream()->fail()) {
-		std::cerr << "Failed to open file for writing." << std::endl;
-		return -1; // or handle error differently
-	}
+	// Read with: ./ns3 run "scratch/trace-dump --input=wifi-download-completion-times.btr"
+	Ptr<BinaryTraceWriter> trace = Create<BinaryTraceWriter>("wifi-download-completion-times.btr");
+	TraceSinks(trace, sinkApps);
+	uint32_t completionContext = trace->Intern("Completion");
 	for (uint32_t i = 0; i < sinkApps.GetN(); ++i)
 	{
 		Ptr<Application> app = sinkApps.Get(i);
 		Ipv4Address clientAddress = clientInterfaces.GetAddress(i);
+		uint32_t node = app->GetNode()->GetId();
 
-		app->TraceConnectWithoutContext("Rx", MakeBoundCallback(&TotalRx, stream, clientAddress));
+		app->TraceConnectWithoutContext("Rx", MakeBoundCallback(&TotalRx, trace, node, completionContext, clientAddress));
 	}
 
 	Simulator::Stop(Seconds(simulationEndTime));
 	Simulator::Run();
+	trace->Close();
 	Simulator::Destroy();
 
 	// Check total bytes received by each client
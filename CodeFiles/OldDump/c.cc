@@ -8,6 +8,9 @@
 #include "ns3/flow-monitor-module.h"
 #include "ns3/flow-monitor-helper.h"
 #include "ns3/packet-sink.h"
+
+#include "../binary-trace.h"
+
 #include <iostream>
 #include <map>
 #include <string>
@@ -19,9 +22,8 @@ NS_LOG_COMPONENT_DEFINE ("WifiDownloadUploadSimulation");
 std::map<Ipv4Address, double> startTime;
 std::map<Ipv4Address, double> endTime;
 
-void TotalRx(Ptr<const Packet> packet, const Address &from, Ptr<OutputStreamWrapper> stream)
+void TotalRx(Ptr<const Packet> packet, const Address &from)
 {
-    std::cout << "Callback triggered at time: " << Simulator::Now().GetSeconds() << std::endl;
     Ipv4Address srcAddr = InetSocketAddress::ConvertFrom(from).GetIpv4();
     double now = Simulator::Now().GetSeconds();
 
@@ -29,8 +31,6 @@ void TotalRx(Ptr<const Packet> packet, const Address &from, Ptr<OutputStreamWrap
         startTime[srcAddr] = now;  // Record start time
     }
     endTime[srcAddr] = now;  // Always update to the last packet's time
-
-    *stream->GetStream() << now << "\t" << packet->GetSize() << std::endl;
 }
 
 
@@ -112,15 +112,16 @@ int main (int argc, char *argv[])
         clientUploadApps.Add(tempApps);
     }
 
-    AsciiTraceHelper ascii;
-    Ptr<OutputStreamWrapper> stream = ascii.CreateFileStream("wifi-download-completion-times.tr");
+    // Read with: ./ns3 run "scratch/trace-dump --input=wifi-download-completion-times.btr"
+    Ptr<BinaryTraceWriter> trace = Create<BinaryTraceWriter>("wifi-download-completion-times.btr");
+    TraceSinks(trace, sinkApps);
     for (uint32_t i = 0; i < sinkApps.GetN(); ++i) {
-        Ptr<Application> app = sinkApps.Get(i);
-        app->TraceConnectWithoutContext("Rx", MakeBoundCallback(&TotalRx, stream));
+        sinkApps.Get(i)->TraceConnectWithoutContext("Rx", MakeCallback(&TotalRx));
     }
 
     Simulator::Stop(Seconds(simulationTime));
     Simulator::Run();
+    trace->Close();
     Simulator::Destroy();
 
     // Calculate and print download completion times for each client
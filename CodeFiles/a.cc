@@ -7,23 +7,38 @@
 #include "ns3/point-to-point-module.h"
 #include "ns3/applications-module.h"
 
+#include "scenario-log.h"
+
 using namespace ns3;
 
 NS_LOG_COMPONENT_DEFINE ("WifiNetworkExample");
 
-int main (int argc, char *argv[])
+void StaAssociated (uint32_t client, Mac48Address bssid)
 {
-    LogComponentEnable("WifiHelper", LOG_LEVEL_ALL);
-    // Example to enable basic logging
-    LogComponentEnable("UdpEchoClientApplication", LOG_LEVEL_INFO);
-    LogComponentEnable("UdpEchoServerApplication", LOG_LEVEL_INFO);
+    SCENARIO_LOG (Info, Mac, "client %u associated", client);
+}
 
+int main (int argc, char *argv[])
+{
     uint32_t numClients = 5; // Specify the number of WiFi clients
+    bool componentLog = false;
 
 
     CommandLine cmd;
     cmd.AddValue ("numClients", "Number of WiFi clients", numClients);
+    cmd.AddValue ("componentLog", "Also enable the ns-3 component logging (WifiHelper, UdpEcho) on stderr", componentLog);
+    ScenarioLog::Get ().AddOptions (cmd);
     cmd.Parse (argc, argv);
+    ScenarioLog::Get ().Start ();
+
+    // Component logging formats every message to stderr and only exists in
+    // debug builds; the scenario log above is the cheap default
+    if (componentLog)
+    {
+        LogComponentEnable("WifiHelper", LOG_LEVEL_ALL);
+        LogComponentEnable("UdpEchoClientApplication", LOG_LEVEL_INFO);
+        LogComponentEnable("UdpEchoServerApplication", LOG_LEVEL_INFO);
+    }
 
 
     
@@ -142,6 +157,11 @@ int main (int argc, char *argv[])
 
     NetDeviceContainer clientDevices;
     clientDevices = wifi.Install (phy, mac, wifiClients);
+    for (uint32_t i = 0; i < clientDevices.GetN (); ++i)
+    {
+        Ptr<WifiNetDevice> device = DynamicCast<WifiNetDevice> (clientDevices.Get (i));
+        device->GetMac ()->TraceConnectWithoutContext ("Assoc", MakeBoundCallback (&StaAssociated, i));
+    }
 
     InternetStackHelper stack;
     stack.Install (wifiApNode);
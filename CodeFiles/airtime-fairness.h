@@ -0,0 +1,318 @@
+#ifndef AIRTIME_FAIRNESS_H
+#define AIRTIME_FAIRNESS_H
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/wifi-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/traffic-control-module.h"
+
+#include "scenario-log.h"
+
+#include <algorithm>
+#include <list>
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace ns3
+{
+
+// Downlink airtime bookkeeping for one AP: which station every PSDU the AP sends
+// is addressed to, how long it occupies the medium, and the resulting airtime
+// cost per byte of each station.
+class AirtimeMeter : public SimpleRefCount<AirtimeMeter>
+{
+public:
+    AirtimeMeter (DataRate defaultRate = DataRate ("65Mbps"))
+        : m_defaultNsPerByte (8e9 / defaultRate.GetBitRate ())
+    {
+    }
+
+    uint32_t AddStation (Ipv4Address ip, Mac48Address mac)
+    {
+        uint32_t index = m_stations.size ();
+        m_stations.push_back ({ip, mac, Time (0), m_defaultNsPerByte, 0});
+        m_byIp[ip] = index;
+        m_byMac[mac] = index;
+        return index;
+    }
+
+    void Attach (Ptr<NetDevice> apDevice)
+    {
+        Ptr<WifiPhy> phy = DynamicCast<WifiNetDevice> (apDevice)->GetPhy ();
+        m_band = phy->GetPhyBand ();
+        phy->TraceConnectWithoutContext ("PhyTxPsduBegin",
+                                         MakeCallback (&AirtimeMeter::PsduTxBegin, this));
+    }
+
+    uint32_t GetNStations () const
+    {
+        return m_stations.size ();
+    }
+
+    // Station the item is destined to; GetNStations () for anything else (ARP, broadcast)
+    uint32_t Classify (Ptr<const QueueDiscItem> item) const
+    {
+        Ptr<const Ipv4QueueDiscItem> ipItem = DynamicCast<const Ipv4QueueDiscItem> (item);
+        if (!ipItem)
+        {
+            return m_stations.size ();
+        }
+        auto it = m_byIp.find (ipItem->GetHeader ().GetDestination ());
+        return it == m_byIp.end () ? m_stations.size () : it->second;
+    }
+
+    int64_t EstimateAirtimeNs (uint32_t station, uint32_t bytes) const
+    {
+        double nsPerByte = station < m_stations.size () ? m_stations[station].nsPerByte
+                                                         : m_defaultNsPerByte;
+        return static_cast<int64_t> (nsPerByte * bytes);
+    }
+
+    void Report (std::ostream &os) const
+    {
+        Time total (0);
+        for (const auto &station : m_stations)
+        {
+            total += station.airtime;
+        }
+        for (std::size_t i = 0; i < m_stations.size (); ++i)
+        {
+            const Station &station = m_stations[i];
+            double share = total.IsPositive () ? 100.0 * station.airtime.GetSeconds () / total.GetSeconds () : 0.0;
+            os << "Client " << i << " downlink airtime " << station.airtime.GetSeconds () << " s"
+               << " share " << share << " % frames " << station.frames << std::endl;
+        }
+    }
+
+private:
+    struct Station
+    {
+        Ipv4Address ip;
+        Mac48Address mac;
+        Time airtime;
+        double nsPerByte;
+        uint64_t frames;
+    };
+
+    void PsduTxBegin (WifiConstPsduMap psduMap, WifiTxVector txVector, double txPowerW)
+    {
+        Time duration = WifiPhy::CalculateTxDuration (psduMap, txVector, m_band);
+
+        for (const auto &entry : psduMap)
+        {
+            Ptr<const WifiPsdu> psdu = entry.second;
+            auto it = m_byMac.find (psdu->GetAddr1 ());
+            if (it == m_byMac.end ())
+            {
+                continue;
+            }
+
+            Station &station = m_stations[it->second];
+            station.airtime += duration;
+            station.frames++;
+            SCENARIO_LOG (Debug, Mac, "station %u psdu airtime %d ns", it->second, duration.GetNanoSeconds ());
+            if (psdu->GetHeader (0).IsQosData () && psdu->GetSize () > 0)
+            {
+                // Slow EWMA, so a single sampling frame does not swing the estimate
+                double sample = static_cast<double> (duration.GetNanoSeconds ()) / psdu->GetSize ();
+                station.nsPerByte = 0.875 * station.nsPerByte + 0.125 * sample;
+            }
+        }
+    }
+
+    double m_defaultNsPerByte;
+    WifiPhyBand m_band = WIFI_PHY_BAND_UNSPECIFIED;
+    std::vector<Station> m_stations;
+    std::map<Ipv4Address, uint32_t> m_byIp;
+    std::map<Mac48Address, uint32_t> m_byMac;
+};
+
+// Deficit round robin over per-station FIFOs where the deficit is counted in
+// airtime rather than bytes: every active station is credited Quantum of
+// airtime per round and charged the estimated airtime of each packet it sends,
+// so stations at a low MCS get fewer packets rather than more of the medium.
+class AirtimeFairQueueDisc : public QueueDisc
+{
+public:
+    static TypeId GetTypeId ()
+    {
+        static TypeId tid =
+            TypeId ("ns3::AirtimeFairQueueDisc")
+                .SetParent<QueueDisc> ()
+                .SetGroupName ("TrafficControl")
+                .AddConstructor<AirtimeFairQueueDisc> ()
+                .AddAttribute ("MaxSize",
+                               "The maximum number of packets accepted by this queue disc",
+                               QueueSizeValue (QueueSize ("1000p")),
+                               MakeQueueSizeAccessor (&QueueDisc::SetMaxSize, &QueueDisc::GetMaxSize),
+                               MakeQueueSizeChecker ())
+                .AddAttribute ("Quantum",
+                               "Airtime credited to each active station per round",
+                               TimeValue (MicroSeconds (1000)),
+                               MakeTimeAccessor (&AirtimeFairQueueDisc::m_quantum),
+                               MakeTimeChecker ());
+        return tid;
+    }
+
+    AirtimeFairQueueDisc ()
+        : QueueDisc (QueueDiscSizePolicy::MULTIPLE_QUEUES, QueueSizeUnit::PACKETS)
+    {
+    }
+
+    void SetMeter (Ptr<AirtimeMeter> meter)
+    {
+        m_meter = meter;
+    }
+
+private:
+    struct StationQueue
+    {
+        Ptr<QueueDiscClass> cls;
+        int64_t deficitNs = 0;
+        bool active = false;
+    };
+
+    bool DoEnqueue (Ptr<QueueDiscItem> item) override
+    {
+        uint32_t index = m_meter ? m_meter->Classify (item) : 0;
+        if (index >= m_queues.size ())
+        {
+            m_queues.resize (index + 1);
+        }
+
+        StationQueue &queue = m_queues[index];
+        if (!queue.cls)
+        {
+            Ptr<QueueDisc> fifo = m_fifoFactory.Create<QueueDisc> ();
+            fifo->Initialize ();
+            queue.cls = CreateObject<QueueDiscClass> ();
+            queue.cls->SetQueueDisc (fifo);
+            AddQueueDiscClass (queue.cls);
+        }
+
+        // A child drop is reported to this queue disc through the class callbacks
+        if (!queue.cls->GetQueueDisc ()->Enqueue (item))
+        {
+            return false;
+        }
+
+        if (!queue.active)
+        {
+            queue.active = true;
+            queue.deficitNs = m_quantum.GetNanoSeconds ();
+            m_active.push_back (index);
+        }
+
+        if (GetCurrentSize () > GetMaxSize ())
+        {
+            DropFromLongestQueue ();
+        }
+        return true;
+    }
+
+    Ptr<QueueDiscItem> DoDequeue () override
+    {
+        while (!m_active.empty ())
+        {
+            uint32_t index = m_active.front ();
+            StationQueue &queue = m_queues[index];
+
+            if (queue.deficitNs <= 0)
+            {
+                queue.deficitNs += m_quantum.GetNanoSeconds ();
+                m_active.splice (m_active.end (), m_active, m_active.begin ());
+                continue;
+            }
+
+            Ptr<QueueDiscItem> item = queue.cls->GetQueueDisc ()->Dequeue ();
+            if (!item)
+            {
+                queue.active = false;
+                m_active.pop_front ();
+                continue;
+            }
+
+            queue.deficitNs -= m_meter ? m_meter->EstimateAirtimeNs (index, item->GetSize ()) : 0;
+            return item;
+        }
+        return nullptr;
+    }
+
+    bool CheckConfig () override
+    {
+        if (GetNQueueDiscClasses () > 0 || GetNInternalQueues () > 0 || GetNPacketFilters () > 0)
+        {
+            NS_LOG_UNCOND ("AirtimeFairQueueDisc creates its own per-station queues and classifier");
+            return false;
+        }
+        return true;
+    }
+
+    void InitializeParams () override
+    {
+        m_fifoFactory.SetTypeId ("ns3::FifoQueueDisc");
+        m_fifoFactory.Set ("MaxSize", QueueSizeValue (GetMaxSize ()));
+    }
+
+    void DropFromLongestQueue ()
+    {
+        StationQueue *longest = nullptr;
+        for (auto &queue : m_queues)
+        {
+            if (queue.cls && (!longest || queue.cls->GetQueueDisc ()->GetNPackets ()
+                                              > longest->cls->GetQueueDisc ()->GetNPackets ()))
+            {
+                longest = &queue;
+            }
+        }
+        Ptr<QueueDiscItem> item = longest->cls->GetQueueDisc ()->Dequeue ();
+        DropAfterDequeue (item, "Overlimit drop");
+    }
+
+    Time m_quantum;
+    Ptr<AirtimeMeter> m_meter;
+    ObjectFactory m_fifoFactory;
+    std::vector<StationQueue> m_queues;
+    std::list<uint32_t> m_active;
+};
+
+NS_OBJECT_ENSURE_REGISTERED (AirtimeFairQueueDisc);
+
+// Installs AirtimeFairQueueDisc on every access-category queue of the AP
+// (replacing whatever --apQueueDisc selected) and points it at the meter.
+inline void InstallAirtimeScheduler (Ptr<NetDevice> apDevice, Ptr<AirtimeMeter> meter)
+{
+    Ptr<NetDeviceQueueInterface> ndqi = apDevice->GetObject<NetDeviceQueueInterface> ();
+    uint16_t nTxQueues = ndqi ? ndqi->GetNTxQueues () : 1;
+
+    TrafficControlHelper tch;
+    uint16_t handle = tch.SetRootQueueDisc ("ns3::MqQueueDisc");
+    TrafficControlHelper::ClassIdList classes =
+        tch.AddQueueDiscClasses (handle, nTxQueues, "ns3::QueueDiscClass");
+    tch.AddChildQueueDiscs (handle, classes, "ns3::AirtimeFairQueueDisc");
+    QueueDiscContainer roots = tch.Install (apDevice);
+
+    Ptr<QueueDisc> root = roots.Get (0);
+    for (std::size_t i = 0; i < root->GetNQueueDiscClasses (); ++i)
+    {
+        DynamicCast<AirtimeFairQueueDisc> (root->GetQueueDiscClass (i)->GetQueueDisc ())->SetMeter (meter);
+    }
+}
+
+// MAC queue size to pair with the scheduler when --apMacQueueSize is not
+// given. With the default 500-packet MAC queues the backlog sits below the
+// queue disc, FIFO, and the deficit order barely applies; a few packets per
+// station keep the backlog in the scheduler while leaving enough for
+// aggregation.
+inline std::string AirtimeMacQueueSize (uint32_t stations)
+{
+    static constexpr uint32_t kPacketsPerStation = 4;
+    return std::to_string (std::max<uint32_t> (stations, 1) * kPacketsPerStation) + "p";
+}
+
+} // namespace ns3
+
+#endif // AIRTIME_FAIRNESS_H
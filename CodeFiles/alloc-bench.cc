@@ -0,0 +1,84 @@
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/point-to-point-module.h"
+#include "ns3/applications-module.h"
+
+#include "pooled-alloc.h"
+
+#include <chrono>
+#include <iostream>
+
+using namespace ns3;
+
+// Allocation counts and wall time of the BulkSend to PacketSink path alone,
+// one TCP download over a point-to-point link, with the heap or the pools:
+//   ./ns3 run "scratch/alloc-bench --allocStats=1"
+//   ./ns3 run "scratch/alloc-bench --allocPool=1"
+// Both print the same counts, so the pair shows what the pools serve and
+// the wall times what that is worth.
+
+POOLED_ALLOCATION_DEFINE ();
+
+int main (int argc, char *argv[])
+{
+    uint64_t bytes = 200 * 1000 * 1000;
+    uint32_t segmentSize = 1448;
+    DataRate rate ("1Gbps");
+    Time delay = MilliSeconds (1);
+
+    CommandLine cmd;
+    cmd.AddValue ("bytes", "Bytes downloaded", bytes);
+    cmd.AddValue ("segmentSize", "TCP segment size", segmentSize);
+    cmd.AddValue ("rate", "Data rate of the link", rate);
+    cmd.AddValue ("delay", "Delay of the link", delay);
+    AllocationMode allocation;
+    allocation.AddOptions (cmd);
+    cmd.Parse (argc, argv);
+    allocation.Install ();
+
+    Config::SetDefault ("ns3::TcpSocket::SegmentSize", UintegerValue (segmentSize));
+    Config::SetDefault ("ns3::TcpSocket::SndBufSize", UintegerValue (1 << 22));
+    Config::SetDefault ("ns3::TcpSocket::RcvBufSize", UintegerValue (1 << 22));
+
+    NodeContainer nodes;
+    nodes.Create (2);
+    PointToPointHelper pointToPoint;
+    pointToPoint.SetDeviceAttribute ("DataRate", DataRateValue (rate));
+    pointToPoint.SetChannelAttribute ("Delay", TimeValue (delay));
+    NetDeviceContainer devices = pointToPoint.Install (nodes);
+    InternetStackHelper stack;
+    stack.Install (nodes);
+    Ipv4AddressHelper address;
+    address.SetBase ("10.1.1.0", "255.255.255.0");
+    Ipv4InterfaceContainer interfaces = address.Assign (devices);
+
+    uint16_t port = 50000;
+    PacketSinkHelper sinkHelper ("ns3::TcpSocketFactory", InetSocketAddress (Ipv4Address::GetAny (), port));
+    ApplicationContainer sinkApp = sinkHelper.Install (nodes.Get (1));
+    BulkSendHelper bulkSend ("ns3::TcpSocketFactory", InetSocketAddress (interfaces.GetAddress (1), port));
+    bulkSend.SetAttribute ("MaxBytes", UintegerValue (bytes));
+    bulkSend.SetAttribute ("SendSize", UintegerValue (segmentSize));
+    bulkSend.Install (nodes.Get (0));
+
+    allocation.Begin ();
+    PooledAllocator::Counters start = PooledAllocator::GetCounters ();
+    auto wallStart = std::chrono::steady_clock::now ();
+    Simulator::Run ();
+    double wallSeconds = std::chrono::duration<double> (std::chrono::steady_clock::now () - wallStart).count ();
+
+    uint64_t received = DynamicCast<PacketSink> (sinkApp.Get (0))->GetTotalRx ();
+    uint64_t allocations = PooledAllocator::GetCounters ().allocations - start.allocations;
+    std::cout << received << " bytes in " << received / segmentSize << " segments, " << Simulator::GetEventCount ()
+              << " events, " << Simulator::Now ().GetSeconds () << " s simulated, " << wallSeconds << " s wall"
+              << std::endl;
+    allocation.Report (std::cout);
+    if (received >= segmentSize && allocations > 0)
+    {
+        std::cout << "Per segment: " << double (allocations) / (received / segmentSize) << " new, "
+                  << wallSeconds * 1e9 / (received / segmentSize) << " ns wall" << std::endl;
+    }
+
+    Simulator::Destroy ();
+    return 0;
+}
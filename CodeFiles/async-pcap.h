@@ -0,0 +1,351 @@
+#ifndef ASYNC_PCAP_H
+#define ASYNC_PCAP_H
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/wifi-module.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <iostream>
+#include <set>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace ns3;
+
+// Radiotap + 802.11 capture of Wi-Fi devices into one pcapng file (one
+// interface per device), written off the simulator thread. The sniffer
+// callbacks only filter, fill a fixed-size slot of a single-producer /
+// single-consumer ring (radiotap fields plus the first snaplen bytes) and
+// publish it; a background thread turns slots into pcapng blocks in a large
+// buffer and writes it out sequentially, through gzip when the file name ends
+// in .gz.
+class AsyncPcapWriter
+{
+public:
+    AsyncPcapWriter (const std::string &fileName, uint32_t snaplen = 128, std::size_t ringSlots = 1 << 16)
+        : m_snaplen (snaplen),
+          m_slotSize ((sizeof (Slot) + snaplen + 7) & ~std::size_t (7)),
+          m_nSlots (ringSlots),
+          m_ring (m_slotSize * ringSlots)
+    {
+        bool gzip = fileName.size () > 3 && fileName.compare (fileName.size () - 3, 3, ".gz") == 0;
+        m_file = gzip ? popen (("gzip -1 > '" + fileName + "'").c_str (), "w") : std::fopen (fileName.c_str (), "wb");
+        m_piped = gzip;
+        if (!m_file)
+        {
+            NS_FATAL_ERROR ("Cannot open pcap output " << fileName);
+        }
+        WriteSectionHeader ();
+    }
+
+    ~AsyncPcapWriter ()
+    {
+        Close ();
+    }
+
+    // Comma-separated node ids and ranges, e.g. "0,3,10-19"; empty captures all
+    void SetNodeFilter (const std::string &nodes)
+    {
+        std::stringstream ss (nodes);
+        std::string item;
+        while (std::getline (ss, item, ','))
+        {
+            std::size_t dash = item.find ('-');
+            uint32_t first = std::stoul (item.substr (0, dash));
+            uint32_t last = dash == std::string::npos ? first : std::stoul (item.substr (dash + 1));
+            for (uint32_t id = first; id <= last; ++id)
+            {
+                m_nodes.insert (id);
+            }
+        }
+    }
+
+    // Only frames in [start, stop) are captured; a zero stop means no end
+    void SetTimeWindow (Time start, Time stop)
+    {
+        m_start = start;
+        m_stop = stop;
+    }
+
+    // Adds one pcapng interface per device that passes the node filter.
+    // Interfaces must all be attached before the simulation starts.
+    void Attach (const NetDeviceContainer &devices)
+    {
+        for (uint32_t i = 0; i < devices.GetN (); ++i)
+        {
+            Ptr<WifiNetDevice> device = DynamicCast<WifiNetDevice> (devices.Get (i));
+            uint32_t nodeId = device->GetNode ()->GetId ();
+            if (!m_nodes.empty () && m_nodes.find (nodeId) == m_nodes.end ())
+            {
+                continue;
+            }
+
+            m_interfaces.push_back ({this, static_cast<uint32_t> (m_interfaces.size ())});
+            Interface *iface = &m_interfaces.back ();
+            WriteInterfaceDescription ("node" + std::to_string (nodeId) + "-dev" + std::to_string (device->GetIfIndex ()));
+
+            Ptr<WifiPhy> phy = device->GetPhy ();
+            phy->TraceConnectWithoutContext ("MonitorSnifferRx", MakeBoundCallback (&AsyncPcapWriter::SnifferRx, iface));
+            phy->TraceConnectWithoutContext ("MonitorSnifferTx", MakeBoundCallback (&AsyncPcapWriter::SnifferTx, iface));
+        }
+    }
+
+    // Drains the ring, stops the writer thread and closes the file
+    void Close ()
+    {
+        if (!m_file)
+        {
+            return;
+        }
+        m_done.store (true, std::memory_order_release);
+        if (m_thread.joinable ())
+        {
+            m_thread.join ();
+        }
+        Flush ();
+        m_piped ? pclose (m_file) : std::fclose (m_file);
+        m_file = nullptr;
+    }
+
+    void Report (std::ostream &os) const
+    {
+        os << "Pcap captured " << m_captured << " frames, " << m_bytesWritten << " bytes written, "
+           << m_stalls << " waits on a full ring" << std::endl;
+    }
+
+private:
+    struct Interface
+    {
+        AsyncPcapWriter *writer;
+        uint32_t id;
+    };
+
+    // Radiotap: TSFT, flags, rate, channel, antenna signal and noise (24 bytes)
+    struct Radiotap
+    {
+        uint8_t version = 0;
+        uint8_t pad = 0;
+        uint16_t length = 24;
+        uint32_t present = (1u << 0) | (1u << 1) | (1u << 2) | (1u << 3) | (1u << 5) | (1u << 6);
+        uint64_t tsft;
+        uint8_t flags = 0x10; // frame includes FCS
+        uint8_t rate;
+        uint16_t channelFrequency;
+        uint16_t channelFlags;
+        int8_t signal;
+        int8_t noise;
+    } __attribute__ ((packed));
+
+    struct Slot
+    {
+        int64_t timeNs;
+        uint32_t iface;
+        uint32_t origLen;
+        uint32_t capLen;
+        uint32_t flags; // pcapng epb_flags: 1 inbound, 2 outbound
+        Radiotap radiotap;
+        // followed by capLen bytes of the frame
+    };
+
+    static void SnifferRx (Interface *iface, Ptr<const Packet> packet, uint16_t channelFreqMhz,
+                           WifiTxVector txVector, MpduInfo aMpdu, SignalNoiseDbm signalNoise, uint16_t staId)
+    {
+        iface->writer->Capture (iface->id, 1, packet, channelFreqMhz, txVector, signalNoise.signal, signalNoise.noise);
+    }
+
+    static void SnifferTx (Interface *iface, Ptr<const Packet> packet, uint16_t channelFreqMhz,
+                           WifiTxVector txVector, MpduInfo aMpdu, uint16_t staId)
+    {
+        iface->writer->Capture (iface->id, 2, packet, channelFreqMhz, txVector, 0.0, 0.0);
+    }
+
+    void Capture (uint32_t iface, uint32_t direction, Ptr<const Packet> packet, uint16_t frequency,
+                  const WifiTxVector &txVector, double signal, double noise)
+    {
+        Time now = Simulator::Now ();
+        if (now < m_start || (m_stop.IsStrictlyPositive () && now >= m_stop))
+        {
+            return;
+        }
+
+        // Interface descriptions are all buffered by now; the writer owns the buffer from here on
+        if (!m_thread.joinable ())
+        {
+            Flush ();
+            m_thread = std::thread (&AsyncPcapWriter::Drain, this);
+        }
+
+        // Wait for the writer rather than lose frames
+        uint64_t head = m_head.load (std::memory_order_relaxed);
+        while (head - m_tail.load (std::memory_order_acquire) >= m_nSlots)
+        {
+            m_stalls++;
+            std::this_thread::yield ();
+        }
+
+        Slot *slot = SlotAt (head);
+        slot->timeNs = now.GetNanoSeconds ();
+        slot->iface = iface;
+        slot->origLen = packet->GetSize () + sizeof (Radiotap);
+        slot->capLen = std::min (packet->GetSize (), m_snaplen);
+        slot->flags = direction;
+        slot->radiotap = Radiotap ();
+        slot->radiotap.tsft = now.GetMicroSeconds ();
+        slot->radiotap.rate = std::min<uint64_t> (255, txVector.GetMode ().GetDataRate (txVector) / 500000);
+        slot->radiotap.channelFrequency = frequency;
+        slot->radiotap.channelFlags = frequency < 3000 ? 0x0080 : 0x0100; // 2 GHz / 5 GHz
+        slot->radiotap.signal = static_cast<int8_t> (std::max (-128.0, std::min (127.0, signal)));
+        slot->radiotap.noise = static_cast<int8_t> (std::max (-128.0, std::min (127.0, noise)));
+        packet->CopyData (reinterpret_cast<uint8_t *> (slot + 1), slot->capLen);
+
+        m_head.store (head + 1, std::memory_order_release);
+        m_captured++;
+    }
+
+    Slot *SlotAt (uint64_t index)
+    {
+        return reinterpret_cast<Slot *> (&m_ring[(index % m_nSlots) * m_slotSize]);
+    }
+
+    void Drain ()
+    {
+        while (true)
+        {
+            bool done = m_done.load (std::memory_order_acquire);
+            uint64_t head = m_head.load (std::memory_order_acquire);
+            uint64_t tail = m_tail.load (std::memory_order_relaxed);
+            for (; tail < head; ++tail)
+            {
+                WriteEnhancedPacket (*SlotAt (tail));
+                if ((tail & 255) == 255)
+                {
+                    m_tail.store (tail + 1, std::memory_order_release);
+                }
+            }
+            m_tail.store (tail, std::memory_order_release);
+            if (m_buffer.size () >= kWriteSize)
+            {
+                Flush ();
+            }
+            if (done && tail == m_head.load (std::memory_order_acquire))
+            {
+                return;
+            }
+            if (tail == head)
+            {
+                std::this_thread::sleep_for (std::chrono::microseconds (200));
+            }
+        }
+    }
+
+    void Flush ()
+    {
+        if (!m_buffer.empty ())
+        {
+            m_bytesWritten += std::fwrite (m_buffer.data (), 1, m_buffer.size (), m_file);
+            m_buffer.clear ();
+        }
+    }
+
+    template <typename T>
+    void Put (T value)
+    {
+        const uint8_t *p = reinterpret_cast<const uint8_t *> (&value);
+        m_buffer.insert (m_buffer.end (), p, p + sizeof (T));
+    }
+
+    void Pad ()
+    {
+        m_buffer.resize ((m_buffer.size () + 3) & ~std::size_t (3), 0);
+    }
+
+    void WriteSectionHeader ()
+    {
+        Put<uint32_t> (0x0A0D0D0A);
+        Put<uint32_t> (28);
+        Put<uint32_t> (0x1A2B3C4D);
+        Put<uint16_t> (1);
+        Put<uint16_t> (0);
+        Put<int64_t> (-1);
+        Put<uint32_t> (28);
+    }
+
+    // Linktype 127 (radiotap), nanosecond timestamps, interface name
+    void WriteInterfaceDescription (const std::string &name)
+    {
+        uint32_t nameLength = (name.size () + 3) & ~3u;
+        uint32_t length = 20 + 4 + nameLength + 4 + 4 + 4;
+        Put<uint32_t> (1);
+        Put<uint32_t> (length);
+        Put<uint16_t> (127);
+        Put<uint16_t> (0);
+        Put<uint32_t> (m_snaplen + sizeof (Radiotap));
+        Put<uint16_t> (2); // if_name
+        Put<uint16_t> (name.size ());
+        m_buffer.insert (m_buffer.end (), name.begin (), name.end ());
+        Pad ();
+        Put<uint16_t> (9); // if_tsresol
+        Put<uint16_t> (1);
+        Put<uint8_t> (9);
+        Pad ();
+        Put<uint32_t> (0); // opt_endofopt
+        Put<uint32_t> (length);
+    }
+
+    void WriteEnhancedPacket (const Slot &slot)
+    {
+        uint32_t capLen = slot.capLen + sizeof (Radiotap);
+        uint32_t length = 28 + ((capLen + 3) & ~3u) + 8 + 4 + 4;
+        uint64_t ts = slot.timeNs;
+        Put<uint32_t> (6);
+        Put<uint32_t> (length);
+        Put<uint32_t> (slot.iface);
+        Put<uint32_t> (ts >> 32);
+        Put<uint32_t> (ts & 0xffffffff);
+        Put<uint32_t> (capLen);
+        Put<uint32_t> (slot.origLen);
+        const uint8_t *radiotap = reinterpret_cast<const uint8_t *> (&slot.radiotap);
+        m_buffer.insert (m_buffer.end (), radiotap, radiotap + sizeof (Radiotap));
+        const uint8_t *frame = reinterpret_cast<const uint8_t *> (&slot + 1);
+        m_buffer.insert (m_buffer.end (), frame, frame + slot.capLen);
+        Pad ();
+        Put<uint16_t> (2); // epb_flags
+        Put<uint16_t> (4);
+        Put<uint32_t> (slot.flags);
+        Put<uint32_t> (0);
+        Put<uint32_t> (length);
+    }
+
+    static constexpr std::size_t kWriteSize = 4 << 20;
+
+    uint32_t m_snaplen;
+    std::size_t m_slotSize;
+    std::size_t m_nSlots;
+    std::vector<uint8_t> m_ring;
+    std::atomic<uint64_t> m_head{0};
+    std::atomic<uint64_t> m_tail{0};
+    std::atomic<bool> m_done{false};
+
+    std::FILE *m_file = nullptr;
+    bool m_piped = false;
+    std::thread m_thread;
+    std::vector<uint8_t> m_buffer;
+
+    std::set<uint32_t> m_nodes;
+    std::deque<Interface> m_interfaces;
+    Time m_start = Time (0);
+    Time m_stop = Time (0);
+    uint64_t m_captured = 0;
+    uint64_t m_stalls = 0;
+    uint64_t m_bytesWritten = 0;
+};
+
+#endif // ASYNC_PCAP_H
@@ -0,0 +1,197 @@
+#ifndef BINARY_TRACE_H
+#define BINARY_TRACE_H
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/applications-module.h"
+
+#include "bulk-trace.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using namespace ns3;
+
+// Compact event trace: a 16-byte file header followed by fixed 32-byte
+// records. Context paths are not repeated per record; each distinct path is
+// defined once by a StringDef record (id in context, length in size) followed
+// by the path bytes padded to whole records, and later records refer to it by
+// id. Read it back with trace-dump.
+enum class TraceEvent : uint8_t
+{
+    StringDef = 0,
+    Rx = 1,
+    Tx = 2,
+    Drop = 3,
+    Completion = 4,
+};
+
+struct TraceRecord
+{
+    int64_t timeNs;
+    uint32_t node;
+    uint16_t device;
+    uint8_t event;
+    uint8_t reserved;
+    uint32_t size;
+    uint32_t flow;    // IPv4 source address for receive events, client index otherwise
+    uint32_t context; // string table id
+    uint32_t aux;     // event specific
+};
+
+static_assert (sizeof (TraceRecord) == 32, "trace records are 32 bytes");
+
+struct TraceFileHeader
+{
+    char magic[8]; // "NS3BTRC\0"
+    uint32_t version;
+    uint32_t recordSize;
+};
+
+inline const char *TraceEventName (uint8_t event)
+{
+    switch (static_cast<TraceEvent> (event))
+    {
+    case TraceEvent::StringDef: return "StringDef";
+    case TraceEvent::Rx: return "Rx";
+    case TraceEvent::Tx: return "Tx";
+    case TraceEvent::Drop: return "Drop";
+    case TraceEvent::Completion: return "Completion";
+    }
+    return "Unknown";
+}
+
+// Buffers records and writes them in 64 KiB blocks
+class BinaryTraceWriter : public SimpleRefCount<BinaryTraceWriter>
+{
+public:
+    explicit BinaryTraceWriter (const std::string &fileName)
+        : m_file (std::fopen (fileName.c_str (), "wb"))
+    {
+        if (!m_file)
+        {
+            NS_FATAL_ERROR ("Cannot open trace file " << fileName);
+        }
+        m_buffer.reserve (kBufferRecords);
+        TraceFileHeader header = {{'N', 'S', '3', 'B', 'T', 'R', 'C', '\0'}, 1, sizeof (TraceRecord)};
+        std::fwrite (&header, sizeof (header), 1, m_file);
+    }
+
+    ~BinaryTraceWriter ()
+    {
+        Close ();
+    }
+
+    // Id of a context path, defining it in the trace the first time it is seen
+    uint32_t Intern (const std::string &context)
+    {
+        auto it = m_strings.find (context);
+        if (it != m_strings.end ())
+        {
+            return it->second;
+        }
+
+        uint32_t id = m_strings.size ();
+        m_strings[context] = id;
+        TraceRecord def = {};
+        def.event = static_cast<uint8_t> (TraceEvent::StringDef);
+        def.size = context.size ();
+        def.context = id;
+        Append (def);
+        for (std::size_t offset = 0; offset < context.size (); offset += sizeof (TraceRecord))
+        {
+            TraceRecord chunk = {};
+            std::memcpy (&chunk, context.data () + offset, std::min (sizeof (TraceRecord), context.size () - offset));
+            Append (chunk);
+        }
+        return id;
+    }
+
+    void Write (TraceEvent event, uint32_t node, uint16_t device, uint32_t size, uint32_t flow,
+                uint32_t context, uint32_t aux = 0)
+    {
+        TraceRecord record;
+        record.timeNs = Simulator::Now ().GetNanoSeconds ();
+        record.node = node;
+        record.device = device;
+        record.event = static_cast<uint8_t> (event);
+        record.reserved = 0;
+        record.size = size;
+        record.flow = flow;
+        record.context = context;
+        record.aux = aux;
+        Append (record);
+    }
+
+    void Close ()
+    {
+        if (m_file)
+        {
+            Flush ();
+            std::fclose (m_file);
+            m_file = nullptr;
+        }
+    }
+
+private:
+    void Append (const TraceRecord &record)
+    {
+        m_buffer.push_back (record);
+        if (m_buffer.size () == kBufferRecords)
+        {
+            Flush ();
+        }
+    }
+
+    void Flush ()
+    {
+        std::fwrite (m_buffer.data (), sizeof (TraceRecord), m_buffer.size (), m_file);
+        m_buffer.clear ();
+    }
+
+    static constexpr std::size_t kBufferRecords = 2048; // 64 KiB
+
+    std::FILE *m_file;
+    std::vector<TraceRecord> m_buffer;
+    std::unordered_map<std::string, uint32_t> m_strings;
+};
+
+inline uint32_t TraceSourceAddress (const Address &from)
+{
+    return InetSocketAddress::IsMatchingType (from) ? InetSocketAddress::ConvertFrom (from).GetIpv4 ().Get () : 0;
+}
+
+// Node and interned context of each sink, by its index in the container
+struct TraceSinkTable : public SimpleRefCount<TraceSinkTable>
+{
+    Ptr<BinaryTraceWriter> trace;
+    std::vector<uint32_t> nodes;
+    std::vector<uint32_t> contexts;
+};
+
+inline void TraceSinkRx (Ptr<TraceSinkTable> table, uint32_t index, Ptr<const Packet> packet, const Address &from)
+{
+    table->trace->Write (TraceEvent::Rx, table->nodes[index], 0, packet->GetSize (), TraceSourceAddress (from),
+                         table->contexts[index]);
+}
+
+// Rx events of every PacketSink in the container, one context per application
+inline void TraceSinks (Ptr<BinaryTraceWriter> trace, const ApplicationContainer &sinks)
+{
+    Ptr<TraceSinkTable> table = Create<TraceSinkTable> ();
+    table->trace = trace;
+    for (uint32_t i = 0; i < sinks.GetN (); ++i)
+    {
+        table->nodes.push_back (sinks.Get (i)->GetNode ()->GetId ());
+        table->contexts.push_back (trace->Intern ("PacketSink/Rx " + std::to_string (i)));
+    }
+    BulkTraceConnect (sinks, "Rx", MakeBoundCallback (&TraceSinkRx, table));
+}
+
+#endif // BINARY_TRACE_H
@@ -0,0 +1,64 @@
+#ifndef BULK_TRACE_H
+#define BULK_TRACE_H
+
+#include "ns3/core-module.h"
+
+#include <cstdint>
+#include <string>
+
+using namespace ns3;
+
+// Connects one callback to the same trace source on every object of a
+// container (NodeContainer, NetDeviceContainer, ApplicationContainer), with
+// the object's index in the container bound as the callback's first
+// argument. Config::Connect parses the path and walks NodeList, every
+// DeviceList or ApplicationList and every attribute on the way for each
+// connection, and TraceConnect looks the source up by name per object; here
+// the TraceSourceAccessor is looked up once per TypeId in the container and
+// each object costs one accessor call.
+//
+// select maps an element to the object holding the source (a device's PHY,
+// an aggregated MobilityModel); elements it maps to null are skipped. The
+// callback's first parameter is the index:
+//
+//   void PhyTx (uint32_t client, WifiConstPsduMap psdus, WifiTxVector txVector, double txPowerW);
+//   BulkTraceConnect (staDevices, "PhyTxPsduBegin", MakeCallback (&PhyTx),
+//                     [] (Ptr<NetDevice> d) { return DynamicCast<WifiNetDevice> (d)->GetPhy (); });
+template <typename Container, typename Select, typename R, typename... Args>
+uint32_t BulkTraceConnect (const Container &container, const std::string &source, Callback<R, uint32_t, Args...> cb,
+                           Select select)
+{
+    TypeId lastTid;
+    Ptr<const TraceSourceAccessor> accessor;
+    uint32_t connected = 0;
+    for (uint32_t i = 0; i < container.GetN (); ++i)
+    {
+        Ptr<Object> object = select (container.Get (i));
+        if (!object)
+        {
+            continue;
+        }
+        TypeId tid = object->GetInstanceTypeId ();
+        if (!accessor || tid != lastTid)
+        {
+            accessor = tid.LookupTraceSourceByName (source);
+            lastTid = tid;
+            if (!accessor)
+            {
+                NS_FATAL_ERROR (tid.GetName () << " has no trace source " << source);
+            }
+        }
+        accessor->ConnectWithoutContext (PeekPointer (object), cb.Bind (i));
+        connected++;
+    }
+    return connected;
+}
+
+// The trace source is on the container's elements themselves
+template <typename Container, typename R, typename... Args>
+uint32_t BulkTraceConnect (const Container &container, const std::string &source, Callback<R, uint32_t, Args...> cb)
+{
+    return BulkTraceConnect (container, source, cb, [] (auto element) -> Ptr<Object> { return element; });
+}
+
+#endif // BULK_TRACE_H
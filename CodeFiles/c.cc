@@ -7,7 +7,11 @@
 #include "ns3/point-to-point-module.h"
 #include "ns3/applications-module.h"
 
+#include "queue-telemetry.h"
+#include "sampled-anim.h"
+
 #include <iostream>
+#include <memory>
 #include <vector>
 
 using namespace ns3;
@@ -51,9 +55,23 @@ void CheckCompletion ()
 int main (int argc, char *argv[])
 {
     uint32_t numClients = 5; // Specify the number of WiFi clients
+    std::string apQueueDisc = "Default";
+    std::string apMacQueueSize = "";
+    std::string sojournHistogram = "";
+    bool uploadLatency = false;
+    std::string animFile = "";
+    double animWindow = 0.1;
+    uint32_t animSample = 100;
 
     CommandLine cmd;
     cmd.AddValue ("numClients", "Number of WiFi clients", numClients);
+    cmd.AddValue ("apQueueDisc", "Queue disc at the AP: Default, Fifo, PfifoFast, CoDel, FqCoDel, Pie, FqPie, Cobalt or Cake", apQueueDisc);
+    cmd.AddValue ("apMacQueueSize", "Size of the AP's Wi-Fi MAC queues, e.g. 32p (empty keeps the default)", apMacQueueSize);
+    cmd.AddValue ("sojournHistogram", "File to write the AP queue sojourn-time histograms to", sojournHistogram);
+    cmd.AddValue ("uploadLatency", "Measure the one-way latency of the UDP uploads", uploadLatency);
+    cmd.AddValue ("anim", "NetAnim file with per-link packet counts per window and sampled packets (empty to disable)", animFile);
+    cmd.AddValue ("animWindow", "Window (s) over which the animation aggregates each link's packets", animWindow);
+    cmd.AddValue ("animSample", "Draw one packet in every animSample per link", animSample);
     cmd.Parse (argc, argv);
 
 
@@ -183,11 +201,26 @@ int main (int argc, char *argv[])
     NetDeviceContainer clientDevices;
     clientDevices = wifi.Install (phy, mac, wifiClients);
 
+    std::unique_ptr<SampledAnimation> anim;
+    if (!animFile.empty ())
+    {
+        anim.reset (new SampledAnimation (animFile, Seconds (animWindow), animSample));
+        anim->AttachWifi (apDevices, clientDevices);
+        anim->AttachPointToPoint (p2pDevices);
+        anim->SetDescription (wifiApNode.Get (0), "AP", 0, 128, 255);
+        anim->SetDescription (serverNode.Get (0), "Server", 0, 192, 0);
+        anim->WriteTopology ();
+    }
+
     InternetStackHelper stack;
     stack.Install (wifiApNode);
     stack.Install (wifiClients);
     stack.Install (serverNode);
 
+    // The AP is the bottleneck between the p2p link and the BSS
+    InstallApQueueDisc (apDevices.Get (0), apQueueDisc);
+    SetApMacQueueSize (apDevices.Get (0), apMacQueueSize);
+
     Ipv4AddressHelper address;
 
     // IP addresses for the p2p network
@@ -338,8 +371,35 @@ int main (int argc, char *argv[])
     // Enable routing
     Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
 
+    SojournTelemetry sojourn;
+    sojourn.Attach (apDevices.Get (0));
+
+    FlowMonitorHelper flowmon;
+    Ptr<FlowMonitor> monitor;
+    if (uploadLatency)
+    {
+        monitor = flowmon.InstallAll ();
+    }
+
     Simulator::Stop (Seconds (20.0));
     Simulator::Run ();
+    if (anim)
+    {
+        anim->Close ();
+        anim->Report (std::cout);
+    }
+
+    sojourn.Report (std::cout);
+    if (!sojournHistogram.empty ())
+    {
+        sojourn.WriteHistograms (sojournHistogram);
+    }
+    if (monitor)
+    {
+        ReportUploadLatency (monitor, DynamicCast<Ipv4FlowClassifier> (flowmon.GetClassifier ()),
+                             clientInterfaces, uploadPort, std::cout);
+    }
+
     Simulator::Destroy ();
     return 0;
 }
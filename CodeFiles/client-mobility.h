@@ -0,0 +1,100 @@
+#ifndef CLIENT_MOBILITY_H
+#define CLIENT_MOBILITY_H
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/mobility-module.h"
+
+#include "random-streams.h"
+
+#include <cstdint>
+#include <string>
+
+using namespace ns3;
+
+// Client movement. The models only keep a position and a velocity from the
+// last course change and extrapolate when GetPosition () is called, so a
+// moving client costs nothing until the channel asks where it is. Random
+// waypoint and trace-driven movement only schedule events at their course
+// changes; Gauss-Markov also re-draws its velocity every TimeStep.
+//
+//   static       ConstantPositionMobilityModel (the default)
+//   waypoint     random waypoint inside the placement disk, speed uniform in
+//                [minSpeed, maxSpeed], pausing pause seconds at each waypoint
+//   gaussMarkov  Gauss-Markov inside the placement disk's bounding box
+//   trace        ns-2 movement file (mobilityTrace), $node_(i) being client i
+struct MobilityParameters
+{
+    std::string model = "static";
+    double minSpeed = 0.5;
+    double maxSpeed = 1.5;
+    double pause = 2.0;
+    std::string traceFile = "";
+};
+
+// Installs the clients' mobility at the given initial positions (ignored by
+// the trace model, which starts each client where the file says)
+inline void InstallClientMobility (const NodeContainer &clients, Ptr<ListPositionAllocator> initial,
+                                   const MobilityParameters &params, double radius)
+{
+    if (params.model == "static")
+    {
+        MobilityHelper mobility;
+        mobility.SetPositionAllocator (initial);
+        mobility.SetMobilityModel ("ns3::ConstantPositionMobilityModel");
+        mobility.Install (clients);
+        return;
+    }
+    if (params.model == "trace")
+    {
+        if (params.traceFile.empty ())
+        {
+            NS_FATAL_ERROR ("mobility=trace needs mobilityTrace");
+        }
+        Ns2MobilityHelper (params.traceFile).Install (clients.Begin (), clients.End ());
+        return;
+    }
+    if (params.model != "waypoint" && params.model != "gaussMarkov")
+    {
+        NS_FATAL_ERROR ("Unknown mobility " << params.model << " (static, waypoint, gaussMarkov or trace)");
+    }
+
+    // One model and one waypoint allocator per client, so AssignClientMobilityStreams
+    // can give each client its own streams
+    for (uint32_t i = 0; i < clients.GetN (); ++i)
+    {
+        Ptr<MobilityModel> model;
+        if (params.model == "waypoint")
+        {
+            Ptr<UniformRandomVariable> speed = CreateObject<UniformRandomVariable> ();
+            speed->SetAttribute ("Min", DoubleValue (params.minSpeed));
+            speed->SetAttribute ("Max", DoubleValue (params.maxSpeed));
+            Ptr<UniformDiscPositionAllocator> waypoints = CreateObject<UniformDiscPositionAllocator> ();
+            waypoints->SetRho (radius);
+            model = CreateObjectWithAttributes<RandomWaypointMobilityModel> (
+                "Speed", PointerValue (speed),
+                "Pause", StringValue ("ns3::ConstantRandomVariable[Constant=" + std::to_string (params.pause) + "]"),
+                "PositionAllocator", PointerValue (waypoints));
+        }
+        else
+        {
+            model = CreateObjectWithAttributes<GaussMarkovMobilityModel> (
+                "Bounds", BoxValue (Box (-radius, radius, -radius, radius, 0.0, 2.0)),
+                "MeanVelocity", StringValue ("ns3::UniformRandomVariable[Min=" + std::to_string (params.minSpeed) +
+                                             "|Max=" + std::to_string (params.maxSpeed) + "]"));
+        }
+        model->SetPosition (initial->GetNext ());
+        clients.Get (i)->AggregateObject (model);
+    }
+}
+
+inline void AssignClientMobilityStreams (const NodeContainer &clients)
+{
+    for (uint32_t i = 0; i < clients.GetN (); ++i)
+    {
+        Ptr<MobilityModel> model = clients.Get (i)->GetObject<MobilityModel> ();
+        model->AssignStreams (StreamIndex (RandomSubsystem::Mobility, clients.Get (i)->GetId ()));
+    }
+}
+
+#endif // CLIENT_MOBILITY_H
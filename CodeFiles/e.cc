@@ -8,23 +8,55 @@
 #include "ns3/applications-module.h"
 #include "ns3/random-variable-stream.h"
 
+#include "airtime-fairness.h"
+#include "async-pcap.h"
+#include "binary-trace.h"
+#include "client-mobility.h"
+#include "event-profiler.h"
+#include "per-table.h"
+#include "phy-tier.h"
+#include "placement.h"
+#include "pooled-alloc.h"
+#include "progress-monitor.h"
+#include "queue-telemetry.h"
+#include "random-streams.h"
+#include "rate-telemetry.h"
+#include "sampled-anim.h"
+#include "result-cache.h"
+#include "scenario-file.h"
+#include "scenario-log.h"
+#include "snr-rate-manager.h"
+#include "soak-monitor.h"
+#include "streaming-stats.h"
+#include "tcp-variants.h"
+
+#include <chrono>
 #include <iostream>
+#include <memory>
 #include <vector>
 
 using namespace ns3;
 
 NS_LOG_COMPONENT_DEFINE ("WifiNetworkExample");
 
+POOLED_ALLOCATION_DEFINE ();
+
 // Struct to hold client data
 struct ClientData
 {
     Ptr<PacketSink> sink;
     uint32_t clientId;
+    Time startTime;
     Time completionTime;
     bool completed;
+    TcpFlowTrace tcp;
 };
 
 std::vector<ClientData> clientDataList;
+CompletionSummary completionSummary;
+Ptr<BinaryTraceWriter> eventTrace;
+uint32_t completionContext = 0;
+uint64_t downloadBytes = 5 * 1024 * 1024;
 
 void CheckCompletion ()
 {
@@ -34,10 +66,18 @@ void CheckCompletion ()
         {
             uint64_t totalBytes = clientData.sink->GetTotalRx ();
 
-            if (totalBytes >= 5 * 1024 * 1024) // 5MB
+            if (totalBytes >= downloadBytes)
             {
                 clientData.completionTime = Simulator::Now ();
                 clientData.completed = true;
+                completionSummary.AddCompletion (clientData.completionTime.GetSeconds ());
+                if (eventTrace)
+                {
+                    eventTrace->Write (TraceEvent::Completion, clientData.sink->GetNode ()->GetId (), 0,
+                                       totalBytes, clientData.clientId, completionContext);
+                }
+
+                SCENARIO_LOG (Info, Scenario, "client %u completed, %u bytes", clientData.clientId, totalBytes);
 
                 std::cout << "Client " << clientData.clientId
                           << " completed at time " << clientData.completionTime.GetSeconds ()
@@ -51,15 +91,138 @@ void CheckCompletion ()
 
 int main (int argc, char *argv[])
 {
+    // RTS/CTS for every frame (threshold zero), unless the scenario file or
+    // --ns3::WifiRemoteStationManager::RtsCtsThreshold says otherwise
     Config::SetDefault ("ns3::WifiRemoteStationManager::RtsCtsThreshold", StringValue ("0"));
 
     Config::SetDefault ("ns3::WifiRemoteStationManager::NonUnicastMode", StringValue ("HtMcs0"));
 
     uint32_t numClients = 5; // Specify the number of WiFi clients
-
-     CommandLine cmd;
+    std::string apQueueDisc = "Default";
+    std::string apMacQueueSize = "";
+    std::string sojournHistogram = "";
+    std::string rateTelemetryFile = "";
+    bool uploadLatency = false;
+    bool airtimeFairness = false;
+    bool fixedStreams = true;
+    double startJitter = 0.0;
+    std::string summaryFile = "";
+    std::string ecdfFile = "";
+    std::string tcpVariant = "NewReno";
+    std::string cwndTrace = "";
+    std::string eventTraceFile = "e-events.btr";
+    std::string pcapFile = "";
+    std::string pcapNodes = "";
+    double pcapStart = 0.0;
+    double pcapStop = 0.0;
+    uint32_t pcapSnaplen = 128;
+    std::string animFile = "";
+    double animWindow = 0.1;
+    uint32_t animSample = 100;
+    PlacementParameters placement;
+    MobilityParameters clientMobility;
+    Vector serverPosition (0.0, -20.0, 0.0);
+    DataRate p2pDataRate ("1000Mbps");
+    Time p2pDelay = MilliSeconds (100);
+    double lossExponent = 4.0;
+    double nakagamiM0 = 0.5;
+    double nakagamiM1 = 0.75;
+    double nakagamiM2 = 1.0;
+    std::string rateManager = "ns3::MinstrelHtWifiManager";
+    std::string errorModel = "";
+    bool perTable = false;
+    std::string phyTierName = "yans";
+    double stopTime = 20.0;
+
+    RecordingCommandLine cmd;
     cmd.AddValue ("numClients", "Number of WiFi clients", numClients);
-    cmd.Parse (argc, argv);
+    cmd.AddValue ("placement", "Client layout: ring, line, grid, hex, disk, poisson or clusters", placement.layout);
+    cmd.AddValue ("radius", "Radius (m) of the ring, or of the disk the random layouts fill", placement.radius);
+    cmd.AddValue ("spacing", "Distance (m) between neighbours in the line, grid and hex layouts", placement.spacing);
+    cmd.AddValue ("minSeparation", "Minimum distance (m) between nodes in the poisson layout", placement.minSeparation);
+    cmd.AddValue ("clusters", "Number of hotspots in the clusters layout", placement.clusters);
+    cmd.AddValue ("clusterSpread", "Standard deviation (m) of clients around their hotspot", placement.clusterSpread);
+    cmd.AddValue ("mobility", "Client mobility: static, waypoint, gaussMarkov or trace", clientMobility.model);
+    cmd.AddValue ("minSpeed", "Minimum client speed (m/s) for waypoint and gaussMarkov", clientMobility.minSpeed);
+    cmd.AddValue ("maxSpeed", "Maximum client speed (m/s) for waypoint and gaussMarkov", clientMobility.maxSpeed);
+    cmd.AddValue ("pause", "Pause (s) at each waypoint", clientMobility.pause);
+    cmd.AddValue ("mobilityTrace", "ns-2 movement file for mobility=trace", clientMobility.traceFile);
+    cmd.AddValue ("serverPosition", "Position of the server node, x:y:z (m)", serverPosition);
+    cmd.AddValue ("p2pDataRate", "Data rate of the AP-server link", p2pDataRate);
+    cmd.AddValue ("p2pDelay", "Delay of the AP-server link", p2pDelay);
+    cmd.AddValue ("lossExponent", "Log-distance path loss exponent", lossExponent);
+    cmd.AddValue ("nakagamiM0", "Nakagami m for the shortest distances", nakagamiM0);
+    cmd.AddValue ("nakagamiM1", "Nakagami m for intermediate distances", nakagamiM1);
+    cmd.AddValue ("nakagamiM2", "Nakagami m for the longest distances", nakagamiM2);
+    cmd.AddValue ("rateManager", "Wi-Fi rate control (WifiRemoteStationManager type)", rateManager);
+    cmd.AddValue ("errorModel", "Wi-Fi error-rate model (ErrorRateModel type; empty for ns3::TableBasedErrorRateModel, required with --perTable)", errorModel);
+    cmd.AddValue ("perTable", "Answer error-rate queries from PER tables of errorModel (NIST or Yans)", perTable);
+    cmd.AddValue ("phyTier", "PHY fidelity: yans or spectrum", phyTierName);
+    cmd.AddValue ("downloadBytes", "Bytes each client downloads", downloadBytes);
+    cmd.AddValue ("stopTime", "Simulated time (s) at which the run ends", stopTime);
+    cmd.AddValue ("tcpVariant", "TCP congestion control, or a comma-separated list cycled over the clients (e.g. Cubic,Bbr,WestwoodPlus,Vegas)", tcpVariant);
+    cmd.AddValue ("cwndTrace", "File to write per-client congestion window traces to (empty to disable)", cwndTrace);
+    cmd.AddValue ("apQueueDisc", "Queue disc at the AP: Default, Fifo, PfifoFast, CoDel, FqCoDel, Pie, FqPie, Cobalt or Cake", apQueueDisc);
+    cmd.AddValue ("apMacQueueSize", "Size of the AP's Wi-Fi MAC queues, e.g. 32p (empty keeps the default, or a few packets per client with --airtimeFairness)", apMacQueueSize);
+    cmd.AddValue ("sojournHistogram", "File to write the AP queue sojourn-time histograms to", sojournHistogram);
+    cmd.AddValue ("rateTelemetry", "File to write per-client rate-control telemetry to (also reported per client)", rateTelemetryFile);
+    cmd.AddValue ("uploadLatency", "Measure the one-way latency of the UDP uploads", uploadLatency);
+    cmd.AddValue ("airtimeFairness", "Schedule the AP downlink by airtime deficit per station instead of FIFO", airtimeFairness);
+    cmd.AddValue ("fixedStreams", "Draw each node's fading, backoff, Minstrel and app randomness from fixed named streams", fixedStreams);
+    cmd.AddValue ("startJitter", "Maximum random delay (ms) added to each download's start", startJitter);
+    cmd.AddValue ("summaryFile", "Completion-time summary file; an existing summary there is merged with this run", summaryFile);
+    cmd.AddValue ("ecdfFile", "File to write this run's completion-time ECDF to", ecdfFile);
+    cmd.AddValue ("eventTrace", "Binary event trace (receive and completion events), read with trace-dump (empty to disable)", eventTraceFile);
+    cmd.AddValue ("pcap", "Radiotap pcapng capture of the Wi-Fi devices, written by a background thread (.gz to compress)", pcapFile);
+    cmd.AddValue ("pcapNodes", "Node ids to capture, e.g. 0,3,10-19 (empty for all)", pcapNodes);
+    cmd.AddValue ("pcapStart", "Start of the capture window (s)", pcapStart);
+    cmd.AddValue ("pcapStop", "End of the capture window (s, 0 for the end of the run)", pcapStop);
+    cmd.AddValue ("pcapSnaplen", "Bytes of each frame to capture", pcapSnaplen);
+    cmd.AddValue ("anim", "NetAnim file with per-link packet counts per window and sampled packets (empty to disable)", animFile);
+    cmd.AddValue ("animWindow", "Window (s) over which the animation aggregates each link's packets", animWindow);
+    cmd.AddValue ("animSample", "Draw one packet in every animSample per link", animSample);
+    ResultCache cache;
+    cache.AddOptions (cmd);
+    ProgressPublisher progress;
+    progress.AddOptions (cmd);
+    ScenarioLog::Get ().AddOptions (cmd);
+    EventProfiler profiler;
+    profiler.AddOptions (cmd);
+    AllocationMode allocation;
+    allocation.AddOptions (cmd);
+    SoakMonitor soak;
+    soak.AddOptions (cmd);
+    ScenarioFile scenario;
+    scenario.AddOptions (cmd);
+    scenario.Parse (cmd, argc, argv);
+    ScenarioLog::Get ().Start ();
+    profiler.Install ();
+    allocation.Install ();
+    soak.Install ();
+
+    std::vector<std::string> tcpVariants = ParseTcpVariants (tcpVariant);
+    ConfigureTcpVariants (tcpVariants);
+
+    // Identical configuration and build already simulated: replay its results
+    cache.SetKey (argv[0], cmd);
+    cache.AddOutputFile (cwndTrace);
+    cache.AddOutputFile (sojournHistogram);
+    cache.AddOutputFile (rateTelemetryFile);
+    cache.AddOutputFile (ecdfFile);
+    cache.AddOutputFile (pcapFile);
+    cache.AddOutputFile (eventTraceFile);
+    cache.AddOutputFile (animFile);
+    if (cache.Replay (std::cout))
+    {
+        if (!summaryFile.empty ())
+        {
+            CompletionSummary cached;
+            cached.Load (cache.GetEntryFile ("summary"));
+            cached.Save (summaryFile);
+        }
+        return 0;
+    }
+    cache.BeginCapture ();
 
 
     NodeContainer wifiClients;
@@ -141,24 +304,11 @@ int main (int argc, char *argv[])
     */
 
     // Setup mobility for the clients
-    MobilityHelper mobilityClients;
-
-    Ptr<ListPositionAllocator> positionAllocClients = CreateObject<ListPositionAllocator> ();
-
-    double radius = 5.0; // Adjust the radius as desired
-    numClients = wifiClients.GetN();
-
-    for (uint32_t i = 0; i < numClients; ++i)
-    {
-        double angle = i * (2.0 * M_PI / numClients);
-        double x = radius * std::cos(angle);
-        double y = radius * std::sin(angle);
-        positionAllocClients->Add (Vector (x, y, 0.0));
-    }
+    // Drawn from its own stream, so changing the layout leaves every other stream alone
+    PlacementGenerator placementGenerator (placement, fixedStreams ? StreamIndex (RandomSubsystem::Placement, 0) : -1);
+    Ptr<ListPositionAllocator> positionAllocClients = placementGenerator.CreateAllocator (wifiClients.GetN ());
 
-    mobilityClients.SetPositionAllocator (positionAllocClients);
-    mobilityClients.SetMobilityModel ("ns3::ConstantPositionMobilityModel");
-    mobilityClients.Install (wifiClients);
+    InstallClientMobility (wifiClients, positionAllocClients, clientMobility, placement.radius);
 
     // Setup mobility for the AP
     MobilityHelper mobilityAp;
@@ -171,7 +321,7 @@ int main (int argc, char *argv[])
      // (Optional) Setup mobility for the server node
     MobilityHelper mobilityServer;
     Ptr<ListPositionAllocator> positionAllocServer = CreateObject<ListPositionAllocator> ();
-    positionAllocServer->Add (Vector (0.0, -20.0, 0.0)); // Position it below the AP
+    positionAllocServer->Add (serverPosition); // Below the AP by default
     mobilityServer.SetPositionAllocator (positionAllocServer);
     mobilityServer.SetMobilityModel ("ns3::ConstantPositionMobilityModel");
     mobilityServer.Install (serverNode);
@@ -188,8 +338,8 @@ int main (int argc, char *argv[])
 
     // Point-to-point link between AP and server
     PointToPointHelper pointToPoint;
-    pointToPoint.SetDeviceAttribute ("DataRate", StringValue ("1000Mbps"));
-    pointToPoint.SetChannelAttribute ("Delay", StringValue ("100ms"));
+    pointToPoint.SetDeviceAttribute ("DataRate", DataRateValue (p2pDataRate));
+    pointToPoint.SetChannelAttribute ("Delay", TimeValue (p2pDelay));
 
     NetDeviceContainer p2pDevices;
     p2pDevices = pointToPoint.Install (wifiApNode.Get (0), serverNode.Get (0));
@@ -199,17 +349,32 @@ int main (int argc, char *argv[])
     channel.SetPropagationDelay("ns3::ConstantSpeedPropagationDelayModel");
     // channel.AddPropagationLoss("ns3::LogDistancePropagationLossModel");
     channel.AddPropagationLoss("ns3::LogDistancePropagationLossModel",
-                           "Exponent", DoubleValue(4.0));
+                           "Exponent", DoubleValue(lossExponent));
     // channel.AddPropagationLoss("ns3::NakagamiPropagationLossModel");
     channel.AddPropagationLoss("ns3::NakagamiPropagationLossModel",
-                           "m0", DoubleValue(0.5),
-                           "m1", DoubleValue(0.75),
-                           "m2", DoubleValue(1.0));
+                           "m0", DoubleValue(nakagamiM0),
+                           "m1", DoubleValue(nakagamiM1),
+                           "m2", DoubleValue(nakagamiM2));
 
 
-    // Create a PHY helper
-    YansWifiPhyHelper phy = YansWifiPhyHelper();
-    phy.SetChannel(channel.Create());
+    // Create a PHY helper for the selected tier
+    Ptr<YansWifiChannel> wifiChannel = channel.Create ();
+    PhyTier phyTier (phyTierName, wifiChannel);
+    WifiPhyHelper &phy = phyTier.GetHelper ();
+    if (perTable)
+    {
+        // Named explicitly, so toggling --perTable alone never changes the
+        // exact model; the default TableBased cannot be tabulated (see per-table.h)
+        if (errorModel.empty ())
+        {
+            NS_FATAL_ERROR ("--perTable needs --errorModel (ns3::NistErrorRateModel or ns3::YansErrorRateModel)");
+        }
+        phy.SetErrorRateModel ("ns3::TabulatedErrorRateModel", "ExactModel", StringValue (errorModel));
+    }
+    else
+    {
+        phy.SetErrorRateModel (errorModel.empty () ? "ns3::TableBasedErrorRateModel" : errorModel);
+    }
 
     // For both part d and part e
 
@@ -219,11 +384,8 @@ int main (int argc, char *argv[])
 
 
     WifiHelper wifi;
-    // Set MinstrelHT as the rate adaptation manager
-    wifi.SetRemoteStationManager ("ns3::MinstrelHtWifiManager");
-
-    // **Enable RTS/CTS by setting the threshold to zero**
-    Config::SetDefault ("ns3::WifiRemoteStationManager::RtsCtsThreshold", StringValue ("0"));
+    // Rate adaptation: MinstrelHT unless --rateManager picks another (e.g. ns3::SnrTableWifiManager)
+    wifi.SetRemoteStationManager (rateManager);
 
     WifiMacHelper mac;
     Ssid ssid = Ssid ("ns3-wifi");
@@ -243,11 +405,48 @@ int main (int argc, char *argv[])
     NetDeviceContainer clientDevices;
     clientDevices = wifi.Install (phy, mac, wifiClients);
 
+    std::unique_ptr<AsyncPcapWriter> pcapWriter;
+    if (!pcapFile.empty ())
+    {
+        pcapWriter.reset (new AsyncPcapWriter (pcapFile, pcapSnaplen));
+        pcapWriter->SetNodeFilter (pcapNodes);
+        pcapWriter->SetTimeWindow (Seconds (pcapStart), Seconds (pcapStop));
+        pcapWriter->Attach (apDevices);
+        pcapWriter->Attach (clientDevices);
+    }
+
+    std::unique_ptr<SampledAnimation> anim;
+    if (!animFile.empty ())
+    {
+        anim.reset (new SampledAnimation (animFile, Seconds (animWindow), animSample));
+        anim->AttachWifi (apDevices, clientDevices);
+        anim->AttachPointToPoint (p2pDevices);
+        anim->SetDescription (wifiApNode.Get (0), "AP", 0, 128, 255);
+        anim->SetDescription (serverNode.Get (0), "Server", 0, 192, 0);
+        anim->WriteTopology ();
+    }
+
     InternetStackHelper stack;
     stack.Install (wifiApNode);
     stack.Install (wifiClients);
     stack.Install (serverNode);
 
+    // The AP is the bottleneck between the p2p link and the BSS
+    Ptr<AirtimeMeter> airtime = Create<AirtimeMeter> ();
+    if (airtimeFairness)
+    {
+        InstallAirtimeScheduler (apDevices.Get (0), airtime);
+        if (apMacQueueSize.empty ())
+        {
+            apMacQueueSize = AirtimeMacQueueSize (numClients);
+        }
+    }
+    else
+    {
+        InstallApQueueDisc (apDevices.Get (0), apQueueDisc);
+    }
+    SetApMacQueueSize (apDevices.Get (0), apMacQueueSize);
+
     Ipv4AddressHelper address;
 
     // IP addresses for the p2p network
@@ -260,9 +459,27 @@ int main (int argc, char *argv[])
     Ipv4InterfaceContainer wifiApInterface = address.Assign (apDevices);
     Ipv4InterfaceContainer clientInterfaces = address.Assign (clientDevices);
 
+    // Per-client downlink airtime, which the airtime scheduler also charges against
+    for (uint32_t i = 0; i < wifiClients.GetN (); ++i)
+    {
+        airtime->AddStation (clientInterfaces.GetAddress (i),
+                             Mac48Address::ConvertFrom (clientDevices.Get (i)->GetAddress ()));
+    }
+    airtime->Attach (apDevices.Get (0));
+
+    RateTelemetry rateTelemetry;
+    if (!rateTelemetryFile.empty ())
+    {
+        rateTelemetry.Attach (apDevices.Get (0), clientDevices);
+    }
+
     // Install PacketSink on each client for download
     ApplicationContainer clientApps;
 
+    // Sized once: per-client state does not grow during the run, and the
+    // TCP hooks keep pointers into it
+    clientDataList.reserve (wifiClients.GetN ());
+
     for (uint32_t i = 0; i < wifiClients.GetN (); ++i)
     {
         uint16_t port = 50000 + i;
@@ -273,7 +490,7 @@ int main (int argc, char *argv[])
         ApplicationContainer app = packetSinkHelper.Install (wifiClients.Get (i));
 
         app.Start (Seconds (0.0));
-        app.Stop (Seconds (20.0));
+        app.Stop (Seconds (stopTime));
 
         clientApps.Add (app);
 
@@ -284,8 +501,18 @@ int main (int argc, char *argv[])
         clientData.clientId = i;
         clientData.completionTime = Seconds (0.0);
         clientData.completed = false;
+        clientData.startTime = Seconds (1.0) + StartJitter (wifiClients.Get (i)->GetId (), MilliSeconds (startJitter), fixedStreams);
+        clientData.tcp.variant = tcpVariants[i % tcpVariants.size ()];
 
         clientDataList.push_back (clientData);
+        progress.AddClient (sink);
+    }
+
+    Ptr<OutputStreamWrapper> cwndStream;
+    if (!cwndTrace.empty ())
+    {
+        AsciiTraceHelper ascii;
+        cwndStream = ascii.CreateFileStream (cwndTrace);
     }
 
     // Install BulkSendApplication on the server for each client (Download)
@@ -298,14 +525,19 @@ int main (int argc, char *argv[])
         BulkSendHelper bulkSend ("ns3::TcpSocketFactory",
                                  InetSocketAddress (clientInterfaces.GetAddress (i), port));
 
-        bulkSend.SetAttribute ("MaxBytes", UintegerValue (5 * 1024 * 1024)); // 5MB
+        bulkSend.SetAttribute ("MaxBytes", UintegerValue (downloadBytes));
 
         ApplicationContainer app = bulkSend.Install (serverNode.Get (0));
 
-        app.Start (Seconds (1.0));
-        app.Stop (Seconds (20.0));
+        app.Start (clientDataList[i].startTime);
+        app.Stop (Seconds (stopTime));
 
         serverApps.Add (app);
+
+        // Hook the socket once BulkSend has created it at its start time
+        Simulator::Schedule (clientDataList[i].startTime + TimeStep (1), &AttachTcpFlow,
+                             DynamicCast<BulkSendApplication> (app.Get (0)),
+                             &clientDataList[i].tcp, tcpVariants.size () > 1, i, cwndStream);
     }
 
     // **Part e: Add Upload Application with RTS/CTS enabled**
@@ -317,7 +549,9 @@ int main (int argc, char *argv[])
 
     ApplicationContainer serverSinkApp = serverPacketSinkHelper.Install (serverNode.Get (0));
     serverSinkApp.Start (Seconds (0.0));
-    serverSinkApp.Stop (Seconds (20.0));
+    serverSinkApp.Stop (Seconds (stopTime));
+
+    ApplicationContainer uploadApps;
 
     // Install OnOffApplication on each client to upload data to the server
     for (uint32_t i = 0; i < wifiClients.GetN (); ++i)
@@ -336,7 +570,33 @@ int main (int argc, char *argv[])
 
         ApplicationContainer clientUploadApp = clientOnOff.Install (wifiClients.Get (i));
         clientUploadApp.Start (Seconds (0.0));
-        clientUploadApp.Stop (Seconds (20.0));
+        clientUploadApp.Stop (Seconds (stopTime));
+        uploadApps.Add (clientUploadApp);
+    }
+
+    // Same node, same streams in every variant (common random numbers)
+    if (fixedStreams)
+    {
+        AssignChannelStreams (wifiChannel);
+        AssignWifiStreams (apDevices);
+        AssignWifiStreams (clientDevices);
+        AssignStackStreams (NodeContainer::GetGlobal ());
+        AssignClientMobilityStreams (wifiClients);
+
+        ApplicationContainer apps;
+        apps.Add (clientApps);
+        apps.Add (serverApps);
+        apps.Add (serverSinkApp);
+        apps.Add (uploadApps);
+        AssignApplicationStreams (apps);
+    }
+
+    if (!eventTraceFile.empty ())
+    {
+        eventTrace = Create<BinaryTraceWriter> (eventTraceFile);
+        completionContext = eventTrace->Intern ("Completion");
+        TraceSinks (eventTrace, clientApps);
+        TraceSinks (eventTrace, serverSinkApp);
     }
 
     // Start checking for completion
@@ -345,8 +605,107 @@ int main (int argc, char *argv[])
     // Enable routing
     Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
 
-    Simulator::Stop (Seconds (20.0));
+    SojournTelemetry sojourn;
+    sojourn.Attach (apDevices.Get (0));
+
+    FlowMonitorHelper flowmon;
+    Ptr<FlowMonitor> monitor;
+    if (uploadLatency)
+    {
+        monitor = flowmon.InstallAll ();
+    }
+
+    progress.Start (Seconds (stopTime), downloadBytes);
+    soak.Start ();
+
+    Simulator::Stop (Seconds (stopTime));
+    allocation.Begin ();
+    auto wallStart = std::chrono::steady_clock::now ();
     Simulator::Run ();
+    double wallSeconds = std::chrono::duration<double> (std::chrono::steady_clock::now () - wallStart).count ();
+    allocation.Report (std::cerr);
+    soak.Report (std::cerr);
+    progress.Finish ();
+    if (eventTrace)
+    {
+        eventTrace->Close ();
+    }
+    if (pcapWriter)
+    {
+        pcapWriter->Close ();
+        pcapWriter->Report (std::cout);
+    }
+    if (anim)
+    {
+        anim->Close ();
+        anim->Report (std::cout);
+    }
+    if (perTable)
+    {
+        TabulatedErrorRateModel::Report (std::cout);
+    }
+
+    // Per-client throughput over the download (incomplete clients up to the end of the run)
+    for (const auto &clientData : clientDataList)
+    {
+        Time end = clientData.completed ? clientData.completionTime : Simulator::Now ();
+        double seconds = (end - clientData.startTime).GetSeconds ();
+        completionSummary.AddThroughput (seconds > 0 ? clientData.sink->GetTotalRx () * 8.0 / seconds : 0.0);
+        if (!clientData.completed)
+        {
+            completionSummary.AddIncomplete (end.GetSeconds ());
+        }
+    }
+    if (!rateTelemetryFile.empty ())
+    {
+        rateTelemetry.Finish ();
+        rateTelemetry.AddTo (completionSummary);
+    }
+    completionSummary.EndRun ();
+    completionSummary.Print (std::cout);
+    std::cout << "Simulation: " << Simulator::GetEventCount () << " events in " << wallSeconds << " s wall, "
+              << Simulator::GetEventCount () / std::max (wallSeconds, 1e-9) << " events/s, mean throughput "
+              << completionSummary.GetThroughput ().GetMean () / 1e6 << " Mbps" << std::endl;
+    if (!summaryFile.empty ())
+    {
+        completionSummary.Save (summaryFile);
+    }
+    if (cache.IsEnabled ())
+    {
+        // This run alone, for merging into --summaryFile on a cache hit
+        completionSummary.Save (cache.GetEntryFile ("summary"));
+    }
+    if (!ecdfFile.empty ())
+    {
+        completionSummary.WriteEcdf (ecdfFile);
+    }
+
+    sojourn.Report (std::cout);
+    airtime->Report (std::cout);
+    if (!rateTelemetryFile.empty ())
+    {
+        rateTelemetry.Report (std::cout);
+        rateTelemetry.Write (rateTelemetryFile);
+    }
+    if (!sojournHistogram.empty ())
+    {
+        sojourn.WriteHistograms (sojournHistogram);
+    }
+    if (monitor)
+    {
+        ReportUploadLatency (monitor, DynamicCast<Ipv4FlowClassifier> (flowmon.GetClassifier ()),
+                             clientInterfaces, uploadPort, std::cout);
+    }
+
+    for (const auto &clientData : clientDataList)
+    {
+        std::cout << "Client " << clientData.clientId
+                  << " tcp " << clientData.tcp.variant
+                  << " retransmissions " << clientData.tcp.retransmissions << std::endl;
+    }
+
     Simulator::Destroy ();
+    cwndStream = nullptr; // flush the trace before it is cached
+    cache.Store ();
     return 0;
 }
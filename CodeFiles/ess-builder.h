@@ -0,0 +1,428 @@
+#ifndef ESS_BUILDER_H
+#define ESS_BUILDER_H
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/mobility-module.h"
+#include "ns3/propagation-module.h"
+#include "ns3/wifi-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/point-to-point-module.h"
+#include "ns3/csma-module.h"
+#include "ns3/bridge-module.h"
+
+#include "phy-tier.h"
+#include "placement.h"
+#include "random-streams.h"
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace ns3;
+
+// An extended service set: numAps APs on a square grid apSpacing apart,
+// each with clientsPerAp clients laid out around it (PlacementParameters,
+// drawn from the BSS's own placement stream), wired to one server through
+//
+//   switch  a learning bridge with a CSMA port per AP and one for a gateway
+//           router, all on one backbone subnet, and the server behind the
+//           gateway on a point-to-point link
+//   p2p     a router with a point-to-point link per AP and one to the server
+//
+// The AP links have accessDelay and the server link serverDelay (the 100 ms
+// of the single-AP scenarios). The server link is point-to-point in both
+// fabrics: a CSMA channel stays busy for a frame's whole propagation delay,
+// which at 100 ms would let the server send about ten frames a second.
+//
+// Every BSS has its own SSID, so a client associates with its own AP even
+// when a co-channel neighbour is louder, and its own 10.(k+1).0.0/16 subnet.
+//
+// Channels come from the band's non-overlapping set (1/6/11 at 2.4 GHz, the
+// non-DFS 36-48 and 149-161 at 5 GHz) or --channels, by channelPlan:
+//
+//   greedy      each AP in turn takes the channel with the least median power
+//               from the APs already on it, ties to the least used channel
+//   roundRobin  AP k takes channel k mod the set size
+//   single      every AP on the first channel
+//   isolated    every BSS on a medium of its own: the same placement without
+//               any interference between BSSs, the baseline co-channel
+//               interference is measured against
+struct EssParameters
+{
+    uint32_t numAps = 9;
+    uint32_t clientsPerAp = 5;
+    double apSpacing = 30.0;
+    std::string band = "2.4";
+    std::string channels = "";
+    uint16_t channelWidth = 20;
+    std::string channelPlan = "greedy";
+    std::string backhaul = "switch";
+    DataRate backhaulRate = DataRate ("1000Mbps");
+    Time accessDelay = MicroSeconds (50);
+    Time serverDelay = MilliSeconds (100);
+    double lossExponent = 4.0;
+};
+
+class EssBuilder
+{
+public:
+    // WifiPhy's default CcaSensitivity: a neighbour heard above it defers us
+    static constexpr double kCcaSensitivityDbm = -82.0;
+
+    explicit EssBuilder (const EssParameters &params)
+        : m_params (params)
+    {
+        if (params.numAps == 0 || params.numAps > 254)
+        {
+            NS_FATAL_ERROR ("--numAps must be 1 to 254 (one 10.x.0.0/16 subnet per BSS)");
+        }
+        m_channelSet = ParseChannels (params.channels.empty () ? DefaultChannels (params.band) : params.channels);
+    }
+
+    // Creates and places the nodes, plans the channels, installs the Wi-Fi
+    // devices, the backhaul and the Internet stack, and computes routes.
+    // The loss and delay models come from channelHelper, one channel per
+    // medium.
+    void Install (WifiHelper &wifi, YansWifiChannelHelper &channelHelper, const std::string &phyTier,
+                  const PlacementParameters &placement, bool fixedStreams)
+    {
+        m_bss.resize (m_params.numAps);
+        NodeContainer aps;
+        aps.Create (m_params.numAps);
+        for (auto &bss : m_bss)
+        {
+            bss.clients.Create (m_params.clientsPerAp);
+        }
+        m_server.Create (1);
+        m_fabric.Create (1);
+
+        PlaceNodes (aps, placement, fixedStreams);
+        PlanChannels ();
+
+        uint32_t media = m_params.channelPlan == "isolated" ? m_bss.size () : 1;
+        for (uint32_t m = 0; m < media; ++m)
+        {
+            Ptr<YansWifiChannel> channel = channelHelper.Create ();
+            m_channels.push_back (channel);
+            m_tiers.emplace_back (new PhyTier (phyTier, channel));
+        }
+
+        WifiMacHelper mac;
+        for (uint32_t k = 0; k < m_bss.size (); ++k)
+        {
+            Bss &bss = m_bss[k];
+            WifiPhyHelper &phy = m_tiers[media > 1 ? k : 0]->GetHelper ();
+            std::ostringstream settings;
+            settings << "{" << bss.channel << ", " << m_params.channelWidth << ", "
+                     << (m_params.band == "5" ? "BAND_5GHZ" : "BAND_2_4GHZ") << ", 0}";
+            phy.Set ("ChannelSettings", StringValue (settings.str ()));
+
+            Ssid ssid = Ssid ("ns3-wifi-" + std::to_string (k));
+            mac.SetType ("ns3::ApWifiMac", "Ssid", SsidValue (ssid));
+            bss.apDevice = wifi.Install (phy, mac, bss.ap);
+            mac.SetType ("ns3::StaWifiMac", "Ssid", SsidValue (ssid), "ActiveProbing", BooleanValue (false));
+            bss.clientDevices = wifi.Install (phy, mac, bss.clients);
+        }
+
+        InstallBackhaul (aps);
+    }
+
+    // Fixed streams per medium and per node (common random numbers)
+    void AssignStreams ()
+    {
+        for (uint32_t m = 0; m < m_channels.size (); ++m)
+        {
+            m_channels[m]->AssignStreams (StreamIndex (RandomSubsystem::Fading, m));
+        }
+        for (const auto &bss : m_bss)
+        {
+            AssignWifiStreams (bss.apDevice);
+            AssignWifiStreams (bss.clientDevices);
+        }
+        AssignStackStreams (m_stackNodes);
+    }
+
+    uint32_t GetNBss () const
+    {
+        return m_bss.size ();
+    }
+
+    const NodeContainer &GetClients (uint32_t bss) const
+    {
+        return m_bss[bss].clients;
+    }
+
+    const Ipv4InterfaceContainer &GetClientInterfaces (uint32_t bss) const
+    {
+        return m_bss[bss].clientInterfaces;
+    }
+
+    Ptr<Node> GetServer () const
+    {
+        return m_server.Get (0);
+    }
+
+    uint16_t GetChannelNumber (uint32_t bss) const
+    {
+        return m_bss[bss].channel;
+    }
+
+    // Co-channel APs whose median power at this AP is above CCA sensitivity
+    uint32_t GetCoChannelNeighbours (uint32_t bss) const
+    {
+        return m_bss[bss].neighbours;
+    }
+
+    // Their summed median power at this AP (dBm, -inf with none)
+    double GetCoChannelPowerDbm (uint32_t bss) const
+    {
+        return m_bss[bss].interferenceMw > 0 ? 10.0 * std::log10 (m_bss[bss].interferenceMw) : -INFINITY;
+    }
+
+    void ReportPlan (std::ostream &os) const
+    {
+        os << "ESS: " << m_bss.size () << " APs, " << m_params.clientsPerAp << " clients each, band "
+           << m_params.band << " GHz, plan " << m_params.channelPlan << ", backhaul " << m_params.backhaul
+           << std::endl;
+        for (uint32_t k = 0; k < m_bss.size (); ++k)
+        {
+            const Bss &bss = m_bss[k];
+            char power[32];
+            std::snprintf (power, sizeof (power), "%.1f", GetCoChannelPowerDbm (k));
+            os << "AP " << k << " channel " << bss.channel << " at (" << bss.position.x << ", "
+               << bss.position.y << "): " << bss.neighbours << " co-channel APs above CCA, " << power << " dBm"
+               << std::endl;
+        }
+    }
+
+private:
+    struct Bss
+    {
+        Ptr<Node> ap;
+        NodeContainer clients;
+        Vector position;
+        uint16_t channel = 0;
+        uint32_t neighbours = 0;
+        double interferenceMw = 0.0;
+        NetDeviceContainer apDevice;
+        NetDeviceContainer clientDevices;
+        Ipv4InterfaceContainer clientInterfaces;
+    };
+
+    static std::string DefaultChannels (const std::string &band)
+    {
+        if (band == "2.4")
+        {
+            return "1,6,11";
+        }
+        if (band == "5")
+        {
+            return "36,40,44,48,149,153,157,161";
+        }
+        NS_FATAL_ERROR ("Unknown band " << band << " (2.4 or 5)");
+        return "";
+    }
+
+    static std::vector<uint16_t> ParseChannels (const std::string &list)
+    {
+        std::vector<uint16_t> channels;
+        std::istringstream in (list);
+        std::string item;
+        while (std::getline (in, item, ','))
+        {
+            channels.push_back (std::stoi (item));
+        }
+        if (channels.empty ())
+        {
+            NS_FATAL_ERROR ("No channels in " << list);
+        }
+        return channels;
+    }
+
+    void PlaceNodes (const NodeContainer &aps, const PlacementParameters &placement, bool fixedStreams)
+    {
+        uint32_t columns = std::ceil (std::sqrt (double (m_bss.size ())));
+        MobilityHelper mobility;
+        mobility.SetMobilityModel ("ns3::ConstantPositionMobilityModel");
+        for (uint32_t k = 0; k < m_bss.size (); ++k)
+        {
+            Bss &bss = m_bss[k];
+            bss.ap = aps.Get (k);
+            bss.position = Vector ((k % columns) * m_params.apSpacing, (k / columns) * m_params.apSpacing, 0.0);
+
+            Ptr<ListPositionAllocator> positions = CreateObject<ListPositionAllocator> ();
+            positions->Add (bss.position);
+            mobility.SetPositionAllocator (positions);
+            mobility.Install (bss.ap);
+
+            // Each BSS draws its layout from its own stream, so adding APs
+            // leaves the existing BSSs' clients where they were
+            PlacementGenerator generator (placement, fixedStreams ? StreamIndex (RandomSubsystem::Placement, k) : -1);
+            positions = CreateObject<ListPositionAllocator> ();
+            for (const Vector &offset : generator.Generate (bss.clients.GetN ()))
+            {
+                positions->Add (Vector (bss.position.x + offset.x, bss.position.y + offset.y, offset.z));
+            }
+            mobility.SetPositionAllocator (positions);
+            mobility.Install (bss.clients);
+        }
+    }
+
+    void PlanChannels ()
+    {
+        // Median power of one AP at another: the channel's log-distance term
+        // without fading, at the PHY's default transmit power
+        Ptr<LogDistancePropagationLossModel> median = CreateObject<LogDistancePropagationLossModel> ();
+        median->SetAttribute ("Exponent", DoubleValue (m_params.lossExponent));
+        TypeId::AttributeInformation info;
+        WifiPhy::GetTypeId ().LookupAttributeByName ("TxPowerStart", &info);
+        double txPowerDbm = DynamicCast<const DoubleValue> (info.initialValue)->Get ();
+        auto powerMw = [&] (const Bss &from, const Bss &to) {
+            return std::pow (10.0, median->CalcRxPower (txPowerDbm, from.ap->GetObject<MobilityModel> (),
+                                                        to.ap->GetObject<MobilityModel> ()) / 10.0);
+        };
+
+        std::vector<uint32_t> used (m_channelSet.size (), 0);
+        for (uint32_t k = 0; k < m_bss.size (); ++k)
+        {
+            uint32_t pick = 0;
+            if (m_params.channelPlan == "greedy")
+            {
+                double best = INFINITY;
+                for (uint32_t c = 0; c < m_channelSet.size (); ++c)
+                {
+                    double interference = 0.0;
+                    for (uint32_t j = 0; j < k; ++j)
+                    {
+                        interference += m_bss[j].channel == m_channelSet[c] ? powerMw (m_bss[j], m_bss[k]) : 0.0;
+                    }
+                    if (interference < best || (interference == best && used[c] < used[pick]))
+                    {
+                        best = interference;
+                        pick = c;
+                    }
+                }
+            }
+            else if (m_params.channelPlan == "roundRobin")
+            {
+                pick = k % m_channelSet.size ();
+            }
+            else if (m_params.channelPlan != "single" && m_params.channelPlan != "isolated")
+            {
+                NS_FATAL_ERROR ("Unknown channel plan " << m_params.channelPlan
+                                                        << " (greedy, roundRobin, single or isolated)");
+            }
+            m_bss[k].channel = m_channelSet[pick];
+            used[pick]++;
+        }
+
+        // Isolated BSSs have no co-channel neighbours, whatever their number
+        if (m_params.channelPlan == "isolated")
+        {
+            return;
+        }
+        double ccaMw = std::pow (10.0, kCcaSensitivityDbm / 10.0);
+        for (auto &bss : m_bss)
+        {
+            for (const auto &other : m_bss)
+            {
+                if (&other != &bss && other.channel == bss.channel)
+                {
+                    double mw = powerMw (other, bss);
+                    bss.interferenceMw += mw;
+                    bss.neighbours += mw > ccaMw;
+                }
+            }
+        }
+    }
+
+    void InstallBackhaul (const NodeContainer &aps)
+    {
+        InternetStackHelper stack;
+        m_stackNodes.Add (aps);
+        for (const auto &bss : m_bss)
+        {
+            m_stackNodes.Add (bss.clients);
+        }
+        m_stackNodes.Add (m_server);
+
+        Ipv4AddressHelper address;
+        if (m_params.backhaul == "switch")
+        {
+            // The switch is a bridge and needs no IP stack
+            m_gateway.Create (1);
+            m_stackNodes.Add (m_gateway);
+            stack.Install (m_stackNodes);
+            CsmaHelper csma;
+            csma.SetChannelAttribute ("DataRate", DataRateValue (m_params.backhaulRate));
+            NetDeviceContainer ports;
+            NetDeviceContainer hosts;
+            csma.SetChannelAttribute ("Delay", TimeValue (m_params.accessDelay));
+            for (uint32_t k = 0; k < aps.GetN (); ++k)
+            {
+                NetDeviceContainer link = csma.Install (NodeContainer (aps.Get (k), m_fabric.Get (0)));
+                hosts.Add (link.Get (0));
+                ports.Add (link.Get (1));
+            }
+            NetDeviceContainer link = csma.Install (NodeContainer (m_gateway.Get (0), m_fabric.Get (0)));
+            hosts.Add (link.Get (0));
+            ports.Add (link.Get (1));
+            BridgeHelper bridge;
+            bridge.Install (m_fabric.Get (0), ports);
+
+            address.SetBase ("10.0.0.0", "255.255.0.0");
+            address.Assign (hosts);
+
+            PointToPointHelper p2p;
+            p2p.SetDeviceAttribute ("DataRate", DataRateValue (m_params.backhaulRate));
+            p2p.SetChannelAttribute ("Delay", TimeValue (m_params.serverDelay));
+            address.SetBase ("172.16.0.0", "255.255.255.252");
+            address.Assign (p2p.Install (m_server.Get (0), m_gateway.Get (0)));
+        }
+        else if (m_params.backhaul == "p2p")
+        {
+            m_stackNodes.Add (m_fabric);
+            stack.Install (m_stackNodes);
+            PointToPointHelper p2p;
+            p2p.SetDeviceAttribute ("DataRate", DataRateValue (m_params.backhaulRate));
+            address.SetBase ("172.16.0.0", "255.255.255.252");
+            p2p.SetChannelAttribute ("Delay", TimeValue (m_params.accessDelay));
+            for (uint32_t k = 0; k < aps.GetN (); ++k)
+            {
+                address.Assign (p2p.Install (aps.Get (k), m_fabric.Get (0)));
+                address.NewNetwork ();
+            }
+            p2p.SetChannelAttribute ("Delay", TimeValue (m_params.serverDelay));
+            address.Assign (p2p.Install (m_server.Get (0), m_fabric.Get (0)));
+        }
+        else
+        {
+            NS_FATAL_ERROR ("Unknown backhaul " << m_params.backhaul << " (switch or p2p)");
+        }
+
+        for (uint32_t k = 0; k < m_bss.size (); ++k)
+        {
+            address.SetBase (Ipv4Address ((10u << 24) | ((k + 1) << 16)), "255.255.0.0");
+            address.Assign (m_bss[k].apDevice);
+            m_bss[k].clientInterfaces = address.Assign (m_bss[k].clientDevices);
+        }
+        Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+    }
+
+    EssParameters m_params;
+    std::vector<uint16_t> m_channelSet;
+    std::vector<Bss> m_bss;
+    NodeContainer m_server;
+    NodeContainer m_fabric;
+    NodeContainer m_gateway; // switch fabric: router between the backbone and the server
+    NodeContainer m_stackNodes;
+    std::vector<Ptr<YansWifiChannel>> m_channels;
+    std::vector<std::unique_ptr<PhyTier>> m_tiers;
+};
+
+#endif // ESS_BUILDER_H
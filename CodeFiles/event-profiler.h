@@ -0,0 +1,389 @@
+#ifndef EVENT_PROFILER_H
+#define EVENT_PROFILER_H
+
+#include "ns3/core-module.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cxxabi.h>
+#include <dlfcn.h>
+#include <execinfo.h>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <typeinfo>
+#include <unordered_map>
+#include <vector>
+
+using namespace ns3;
+
+// Simulator implementation that runs another one (Implementation, the
+// default one by default) and wraps every scheduled event, so each event's
+// count and wall time are charged to its kind. The kind is the function the
+// event calls as far as its type tells (the member function's class and
+// signature, or the free function's signature), and with Sites also where it
+// was scheduled from, which tells apart same-signature callbacks such as the
+// CheckCompletion polls. The top entries are printed to stderr at
+// Simulator::Destroy. It is only installed when enabled (EventProfiler), so
+// a run without it executes exactly the default implementation.
+class ProfilingSimulatorImpl : public SimulatorImpl
+{
+public:
+    static TypeId GetTypeId ()
+    {
+        static TypeId tid = TypeId ("ns3::ProfilingSimulatorImpl")
+                                .SetParent<SimulatorImpl> ()
+                                .SetGroupName ("Core")
+                                .AddConstructor<ProfilingSimulatorImpl> ()
+                                .AddAttribute ("Implementation", "Simulator implementation that runs the events",
+                                               StringValue ("ns3::DefaultSimulatorImpl"),
+                                               MakeStringAccessor (&ProfilingSimulatorImpl::m_implName),
+                                               MakeStringChecker ())
+                                .AddAttribute ("Top", "Entries printed at Destroy",
+                                               UintegerValue (20),
+                                               MakeUintegerAccessor (&ProfilingSimulatorImpl::m_top),
+                                               MakeUintegerChecker<uint32_t> ())
+                                .AddAttribute ("Sites", "Also attribute events to the function that scheduled them",
+                                               BooleanValue (false),
+                                               MakeBooleanAccessor (&ProfilingSimulatorImpl::m_sites),
+                                               MakeBooleanChecker ());
+        return tid;
+    }
+
+    void Destroy () override
+    {
+        Report (std::cerr);
+        m_impl->Destroy ();
+    }
+
+    bool IsFinished () const override
+    {
+        return m_impl->IsFinished ();
+    }
+
+    void Stop () override
+    {
+        m_impl->Stop ();
+    }
+
+    EventId Stop (const Time &delay) override
+    {
+        return m_impl->Stop (delay);
+    }
+
+    // The call stack is captured here rather than in a helper, so the
+    // caller is always two frames up (past Simulator::DoSchedule*)
+    EventId Schedule (const Time &delay, EventImpl *event) override
+    {
+        void *frames[kFrames] = {};
+        if (m_sites)
+        {
+            backtrace (frames, kFrames);
+        }
+        return m_impl->Schedule (delay, Wrap (event, frames));
+    }
+
+    void ScheduleWithContext (uint32_t context, const Time &delay, EventImpl *event) override
+    {
+        void *frames[kFrames] = {};
+        if (m_sites)
+        {
+            backtrace (frames, kFrames);
+        }
+        m_impl->ScheduleWithContext (context, delay, Wrap (event, frames));
+    }
+
+    EventId ScheduleNow (EventImpl *event) override
+    {
+        void *frames[kFrames] = {};
+        if (m_sites)
+        {
+            backtrace (frames, kFrames);
+        }
+        return m_impl->ScheduleNow (Wrap (event, frames));
+    }
+
+    EventId ScheduleDestroy (EventImpl *event) override
+    {
+        return m_impl->ScheduleDestroy (event);
+    }
+
+    void Remove (const EventId &id) override
+    {
+        m_impl->Remove (id);
+    }
+
+    void Cancel (const EventId &id) override
+    {
+        m_impl->Cancel (id);
+    }
+
+    bool IsExpired (const EventId &id) const override
+    {
+        return m_impl->IsExpired (id);
+    }
+
+    void Run () override
+    {
+        m_impl->Run ();
+    }
+
+    Time Now () const override
+    {
+        return m_impl->Now ();
+    }
+
+    Time GetDelayLeft (const EventId &id) const override
+    {
+        return m_impl->GetDelayLeft (id);
+    }
+
+    Time GetMaximumSimulationTime () const override
+    {
+        return m_impl->GetMaximumSimulationTime ();
+    }
+
+    void SetScheduler (ObjectFactory schedulerFactory) override
+    {
+        m_impl->SetScheduler (schedulerFactory);
+    }
+
+    uint32_t GetSystemId () const override
+    {
+        return m_impl->GetSystemId ();
+    }
+
+    uint32_t GetContext () const override
+    {
+        return m_impl->GetContext ();
+    }
+
+    uint64_t GetEventCount () const override
+    {
+        return m_impl->GetEventCount ();
+    }
+
+private:
+    // Our Schedule*, Simulator::DoSchedule*, the caller and, when that is an
+    // out-of-line Simulator::Schedule<> instance, its caller
+    static constexpr int kFrames = 4;
+
+    struct Kind
+    {
+        const std::type_info *type;
+        void *site[2];
+        uint64_t count = 0;
+        int64_t ns = 0;
+    };
+
+    struct Key
+    {
+        const std::type_info *type;
+        void *site[2];
+
+        bool operator== (const Key &other) const
+        {
+            return type == other.type && site[0] == other.site[0] && site[1] == other.site[1];
+        }
+    };
+
+    struct KeyHash
+    {
+        std::size_t operator() (const Key &key) const
+        {
+            return std::hash<const void *> () (key.type) * 31 + std::hash<void *> () (key.site[0]) * 17 +
+                   std::hash<void *> () (key.site[1]);
+        }
+    };
+
+    class ProfiledEvent : public EventImpl
+    {
+    public:
+        ProfiledEvent (EventImpl *event, Kind *kind)
+            : m_event (event, false),
+              m_kind (kind)
+        {
+        }
+
+    protected:
+        void Notify () override
+        {
+            auto start = std::chrono::steady_clock::now ();
+            m_event->Invoke ();
+            m_kind->ns += std::chrono::duration_cast<std::chrono::nanoseconds> (std::chrono::steady_clock::now () - start).count ();
+            m_kind->count++;
+        }
+
+    private:
+        Ptr<EventImpl> m_event;
+        Kind *m_kind;
+    };
+
+    void NotifyConstructionCompleted () override
+    {
+        ObjectFactory factory (m_implName);
+        m_impl = factory.Create<SimulatorImpl> ();
+        if (!m_impl)
+        {
+            NS_FATAL_ERROR (m_implName << " is not a SimulatorImpl");
+        }
+        SimulatorImpl::NotifyConstructionCompleted ();
+    }
+
+    void DoDispose () override
+    {
+        m_impl = nullptr;
+        SimulatorImpl::DoDispose ();
+    }
+
+    EventImpl *Wrap (EventImpl *event, void *const frames[kFrames])
+    {
+        Key key {&typeid (*event), {frames[2], frames[3]}};
+        auto it = m_kinds.find (key);
+        if (it == m_kinds.end ())
+        {
+            it = m_kinds.emplace (key, std::unique_ptr<Kind> (new Kind {key.type, {key.site[0], key.site[1]}})).first;
+        }
+        return new ProfiledEvent (event, it->second.get ());
+    }
+
+    static std::string Demangle (const char *name)
+    {
+        int status = 0;
+        char *demangled = abi::__cxa_demangle (name, nullptr, nullptr, &status);
+        std::string result = status == 0 ? demangled : name;
+        std::free (demangled);
+        return result;
+    }
+
+    // MakeEvent's local event classes are named after MakeEvent's arguments;
+    // the first one is the function (pointer type) the event calls
+    static std::string KindName (const std::type_info &type)
+    {
+        std::string name = Demangle (type.name ());
+        const std::string prefix = "ns3::MakeEvent";
+        if (name.compare (0, prefix.size (), prefix) != 0 || name.size () <= prefix.size ())
+        {
+            return name;
+        }
+        char open = name[prefix.size ()];
+        char close = open == '<' ? '>' : ')';
+        int depth = 0;
+        for (std::size_t i = prefix.size (); i < name.size (); ++i)
+        {
+            char c = name[i];
+            depth += (c == '<' || c == '(') - (c == '>' || c == ')');
+            if ((depth == 1 && c == ',') || (depth == 0 && c == close))
+            {
+                return name.substr (prefix.size () + 1, i - prefix.size () - 1);
+            }
+        }
+        return name;
+    }
+
+    // Function containing the address, or module+offset when the symbol is
+    // not exported (functions of the scenario program itself, unless it is
+    // linked with -rdynamic; addr2line -f -e <program> <offset> names them)
+    static std::string SiteName (void *address)
+    {
+        Dl_info info;
+        if (!address || !dladdr (address, &info))
+        {
+            return "?";
+        }
+        if (info.dli_sname)
+        {
+            std::string name = Demangle (info.dli_sname);
+            return name.substr (0, name.find ('('));
+        }
+        const char *module = info.dli_fname ? std::strrchr (info.dli_fname, '/') : nullptr;
+        char offset[32];
+        std::snprintf (offset, sizeof (offset), "+0x%lx",
+                       static_cast<unsigned long> (static_cast<char *> (address) - static_cast<char *> (info.dli_fbase)));
+        return (module ? module + 1 : "?") + std::string (offset);
+    }
+
+    void Report (std::ostream &os) const
+    {
+        std::vector<const Kind *> kinds;
+        int64_t totalNs = 0;
+        for (const auto &entry : m_kinds)
+        {
+            if (entry.second->count > 0)
+            {
+                kinds.push_back (entry.second.get ());
+                totalNs += entry.second->ns;
+            }
+        }
+        std::sort (kinds.begin (), kinds.end (), [] (const Kind *a, const Kind *b) { return a->ns > b->ns; });
+
+        char line[128];
+        os << "Event profile: " << kinds.size () << " kinds, " << totalNs * 1e-9 << " s in events" << std::endl;
+        std::snprintf (line, sizeof (line), "%12s %10s %6s %9s  %s", "events", "wall ms", "%", "ns/event", "kind");
+        os << line << std::endl;
+        for (std::size_t i = 0; i < kinds.size () && i < m_top; ++i)
+        {
+            const Kind *kind = kinds[i];
+            std::string name = KindName (*kind->type);
+            if (m_sites)
+            {
+                std::string site = SiteName (kind->site[0]);
+                if (site.compare (0, 16, "ns3::Simulator::") == 0)
+                {
+                    site = SiteName (kind->site[1]);
+                }
+                name += " from " + site;
+            }
+            std::snprintf (line, sizeof (line), "%12lu %10.1f %6.1f %9.0f  ",
+                           static_cast<unsigned long> (kind->count), kind->ns * 1e-6,
+                           totalNs ? 100.0 * kind->ns / totalNs : 0.0, double (kind->ns) / kind->count);
+            os << line << name << std::endl;
+        }
+    }
+
+    std::string m_implName = "ns3::DefaultSimulatorImpl";
+    uint32_t m_top = 20;
+    bool m_sites = false;
+    Ptr<SimulatorImpl> m_impl;
+    std::unordered_map<Key, std::unique_ptr<Kind>, KeyHash> m_kinds;
+};
+
+NS_OBJECT_ENSURE_REGISTERED (ProfilingSimulatorImpl);
+
+// Command-line switch for the profiler. Registered on the plain CommandLine,
+// since it does not change results; Install must run before anything
+// touches the simulator.
+class EventProfiler
+{
+public:
+    void AddOptions (CommandLine &cmd)
+    {
+        cmd.AddValue ("profile", "Print the N event kinds taking most wall time at the end (0 to disable)", m_top);
+        cmd.AddValue ("profileSites", "Also attribute events to the function that scheduled them", m_sites);
+    }
+
+    void Install ()
+    {
+        if (m_top == 0)
+        {
+            return;
+        }
+        Config::SetDefault ("ns3::ProfilingSimulatorImpl::Top", UintegerValue (m_top));
+        Config::SetDefault ("ns3::ProfilingSimulatorImpl::Sites", BooleanValue (m_sites));
+        GlobalValue::Bind ("SimulatorImplementationType", StringValue ("ns3::ProfilingSimulatorImpl"));
+        if (!DynamicCast<ProfilingSimulatorImpl> (Simulator::GetImplementation ()))
+        {
+            NS_FATAL_ERROR ("The event profiler must be installed before the simulator is first used");
+        }
+    }
+
+private:
+    uint32_t m_top = 0;
+    bool m_sites = false;
+};
+
+#endif // EVENT_PROFILER_H
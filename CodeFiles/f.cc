@@ -0,0 +1,257 @@
+#include "ns3/command-line.h"
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/mobility-module.h"
+#include "ns3/wifi-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/applications-module.h"
+
+#include "ess-builder.h"
+#include "event-profiler.h"
+#include "random-streams.h"
+#include "result-cache.h"
+#include "streaming-stats.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <vector>
+
+using namespace ns3;
+
+// K APs, each with its own clients, sharing or reusing channels and wired to
+// one server (see ess-builder.h). Every client downloads downloadBytes; the
+// run reports completions per client and throughput per BSS. The cost of
+// co-channel interference is the difference from the same ESS with
+// --channelPlan=isolated, e.g. with compareVariants.py (see README).
+
+NS_LOG_COMPONENT_DEFINE ("EssExample");
+
+// Struct to hold client data
+struct ClientData
+{
+    Ptr<PacketSink> sink;
+    uint32_t clientId;
+    uint32_t bss;
+    Time startTime;
+    Time completionTime;
+    bool completed;
+};
+
+std::vector<ClientData> clientDataList;
+CompletionSummary completionSummary;
+uint64_t downloadBytes = 5 * 1024 * 1024;
+
+void CheckCompletion ()
+{
+    for (auto &clientData : clientDataList)
+    {
+        if (!clientData.completed && clientData.sink->GetTotalRx () >= downloadBytes)
+        {
+            clientData.completionTime = Simulator::Now ();
+            clientData.completed = true;
+            completionSummary.AddCompletion (clientData.completionTime.GetSeconds ());
+
+            std::cout << "Client " << clientData.clientId
+                      << " completed at time " << clientData.completionTime.GetSeconds ()
+                      << " seconds" << std::endl;
+        }
+    }
+
+    Simulator::Schedule (MilliSeconds (10), &CheckCompletion);
+}
+
+int main (int argc, char *argv[])
+{
+    EssParameters ess;
+    uint32_t numClients = 0;
+    PlacementParameters placement;
+    placement.layout = "disk";
+    placement.radius = 10.0;
+    bool fixedStreams = true;
+    double startJitter = 0.0;
+    double nakagamiM0 = 0.5;
+    double nakagamiM1 = 0.75;
+    double nakagamiM2 = 1.0;
+    std::string rateManager = "ns3::MinstrelHtWifiManager";
+    std::string phyTierName = "yans";
+    std::string summaryFile = "";
+    double stopTime = 20.0;
+
+    RecordingCommandLine cmd;
+    cmd.AddValue ("numAps", "Number of APs (BSSs)", ess.numAps);
+    cmd.AddValue ("clientsPerAp", "Wi-Fi clients per AP", ess.clientsPerAp);
+    cmd.AddValue ("numClients", "Wi-Fi clients in all, split evenly over the APs (0 to use clientsPerAp)", numClients);
+    cmd.AddValue ("apSpacing", "Distance (m) between neighbouring APs on the grid", ess.apSpacing);
+    cmd.AddValue ("band", "Wi-Fi band (GHz): 2.4 or 5", ess.band);
+    cmd.AddValue ("channels", "Comma-separated channel numbers to assign (empty for the band's non-overlapping set)", ess.channels);
+    cmd.AddValue ("channelWidth", "Channel width (MHz)", ess.channelWidth);
+    cmd.AddValue ("channelPlan", "Channel assignment: greedy, roundRobin, single or isolated", ess.channelPlan);
+    cmd.AddValue ("backhaul", "AP-server fabric: switch or p2p", ess.backhaul);
+    cmd.AddValue ("backhaulRate", "Data rate of every backhaul link", ess.backhaulRate);
+    cmd.AddValue ("accessDelay", "Delay of each AP's backhaul link", ess.accessDelay);
+    cmd.AddValue ("serverDelay", "Delay of the server's backhaul link", ess.serverDelay);
+    cmd.AddValue ("placement", "Client layout around each AP: ring, line, grid, hex, disk, poisson or clusters", placement.layout);
+    cmd.AddValue ("radius", "Radius (m) of the ring, or of the disk the random layouts fill", placement.radius);
+    cmd.AddValue ("spacing", "Distance (m) between neighbours in the line, grid and hex layouts", placement.spacing);
+    cmd.AddValue ("lossExponent", "Log-distance path loss exponent", ess.lossExponent);
+    cmd.AddValue ("nakagamiM0", "Nakagami m for the shortest distances", nakagamiM0);
+    cmd.AddValue ("nakagamiM1", "Nakagami m for intermediate distances", nakagamiM1);
+    cmd.AddValue ("nakagamiM2", "Nakagami m for the longest distances", nakagamiM2);
+    cmd.AddValue ("rateManager", "Wi-Fi rate control (WifiRemoteStationManager type)", rateManager);
+    cmd.AddValue ("phyTier", "PHY fidelity: yans or spectrum", phyTierName);
+    cmd.AddValue ("downloadBytes", "Bytes each client downloads", downloadBytes);
+    cmd.AddValue ("stopTime", "Simulated time (s) at which the run ends", stopTime);
+    cmd.AddValue ("fixedStreams", "Draw each node's fading, backoff, Minstrel and app randomness from fixed named streams", fixedStreams);
+    cmd.AddValue ("startJitter", "Maximum random delay (ms) added to each download's start", startJitter);
+    cmd.AddValue ("summaryFile", "Completion-time summary file; an existing summary there is merged with this run", summaryFile);
+    ResultCache cache;
+    cache.AddOptions (cmd);
+    EventProfiler profiler;
+    profiler.AddOptions (cmd);
+    cmd.Parse (argc, argv);
+    profiler.Install ();
+    if (numClients > 0)
+    {
+        if (numClients % ess.numAps != 0)
+        {
+            NS_FATAL_ERROR ("--numClients=" << numClients << " does not split evenly over " << ess.numAps << " APs");
+        }
+        ess.clientsPerAp = numClients / ess.numAps;
+    }
+
+    // Identical configuration and build already simulated: replay its results
+    cache.SetKey (argv[0], cmd);
+    if (cache.Replay (std::cout))
+    {
+        if (!summaryFile.empty ())
+        {
+            CompletionSummary cached;
+            cached.Load (cache.GetEntryFile ("summary"));
+            cached.Save (summaryFile);
+        }
+        return 0;
+    }
+    cache.BeginCapture ();
+
+    // The propagation of the single-AP scenarios, one channel per medium
+    YansWifiChannelHelper channel;
+    channel.SetPropagationDelay ("ns3::ConstantSpeedPropagationDelayModel");
+    channel.AddPropagationLoss ("ns3::LogDistancePropagationLossModel",
+                                "Exponent", DoubleValue (ess.lossExponent));
+    channel.AddPropagationLoss ("ns3::NakagamiPropagationLossModel",
+                                "m0", DoubleValue (nakagamiM0),
+                                "m1", DoubleValue (nakagamiM1),
+                                "m2", DoubleValue (nakagamiM2));
+
+    WifiHelper wifi;
+    wifi.SetStandard (WIFI_STANDARD_80211n);
+    wifi.SetRemoteStationManager (rateManager);
+
+    EssBuilder builder (ess);
+    builder.Install (wifi, channel, phyTierName, placement, fixedStreams);
+    builder.ReportPlan (std::cout);
+
+    // A download from the server to every client of every BSS
+    ApplicationContainer clientApps;
+    ApplicationContainer serverApps;
+    uint16_t port = 50000;
+    clientDataList.reserve (builder.GetNBss () * ess.clientsPerAp);
+    for (uint32_t k = 0; k < builder.GetNBss (); ++k)
+    {
+        const NodeContainer &clients = builder.GetClients (k);
+        for (uint32_t i = 0; i < clients.GetN (); ++i)
+        {
+            PacketSinkHelper packetSinkHelper ("ns3::TcpSocketFactory",
+                                               InetSocketAddress (Ipv4Address::GetAny (), port));
+            ApplicationContainer sinkApp = packetSinkHelper.Install (clients.Get (i));
+            sinkApp.Start (Seconds (0.0));
+            sinkApp.Stop (Seconds (stopTime));
+            clientApps.Add (sinkApp);
+
+            ClientData clientData;
+            clientData.sink = DynamicCast<PacketSink> (sinkApp.Get (0));
+            clientData.clientId = clientDataList.size ();
+            clientData.bss = k;
+            clientData.completionTime = Seconds (0.0);
+            clientData.completed = false;
+            clientData.startTime = Seconds (1.0) + StartJitter (clients.Get (i)->GetId (), MilliSeconds (startJitter), fixedStreams);
+            clientDataList.push_back (clientData);
+
+            BulkSendHelper bulkSend ("ns3::TcpSocketFactory",
+                                     InetSocketAddress (builder.GetClientInterfaces (k).GetAddress (i), port));
+            bulkSend.SetAttribute ("MaxBytes", UintegerValue (downloadBytes));
+            ApplicationContainer sendApp = bulkSend.Install (builder.GetServer ());
+            sendApp.Start (clientData.startTime);
+            sendApp.Stop (Seconds (stopTime));
+            serverApps.Add (sendApp);
+        }
+    }
+
+    // Same node, same streams in every variant (common random numbers)
+    if (fixedStreams)
+    {
+        builder.AssignStreams ();
+        ApplicationContainer apps;
+        apps.Add (clientApps);
+        apps.Add (serverApps);
+        AssignApplicationStreams (apps);
+    }
+
+    // Start checking for completion
+    Simulator::Schedule (Seconds (1.1), &CheckCompletion);
+
+    Simulator::Stop (Seconds (stopTime));
+    auto wallStart = std::chrono::steady_clock::now ();
+    Simulator::Run ();
+    double wallSeconds = std::chrono::duration<double> (std::chrono::steady_clock::now () - wallStart).count ();
+
+    // Per-client throughput over the download (incomplete clients up to the
+    // end of the run), summed per BSS
+    std::vector<double> bssThroughput (builder.GetNBss (), 0.0);
+    std::vector<uint32_t> bssCompleted (builder.GetNBss (), 0);
+    std::vector<RunningStats> bssCompletion (builder.GetNBss ());
+    for (const auto &clientData : clientDataList)
+    {
+        Time end = clientData.completed ? clientData.completionTime : Simulator::Now ();
+        double seconds = (end - clientData.startTime).GetSeconds ();
+        double throughput = seconds > 0 ? clientData.sink->GetTotalRx () * 8.0 / seconds : 0.0;
+        completionSummary.AddThroughput (throughput);
+        bssThroughput[clientData.bss] += throughput;
+        if (clientData.completed)
+        {
+            bssCompleted[clientData.bss]++;
+            bssCompletion[clientData.bss].Add (clientData.completionTime.GetSeconds ());
+        }
+        else
+        {
+            completionSummary.AddIncomplete (end.GetSeconds ());
+        }
+    }
+    completionSummary.EndRun ();
+    completionSummary.Print (std::cout);
+    std::cout << "Simulation: " << Simulator::GetEventCount () << " events in " << wallSeconds << " s wall, "
+              << Simulator::GetEventCount () / std::max (wallSeconds, 1e-9) << " events/s, mean throughput "
+              << completionSummary.GetThroughput ().GetMean () / 1e6 << " Mbps" << std::endl;
+    for (uint32_t k = 0; k < builder.GetNBss (); ++k)
+    {
+        std::cout << "BSS " << k << " channel " << builder.GetChannelNumber (k) << " co-channel APs "
+                  << builder.GetCoChannelNeighbours (k) << ": " << bssCompleted[k] << "/"
+                  << builder.GetClients (k).GetN () << " completed, mean completion "
+                  << bssCompletion[k].GetMean () << " s, throughput " << bssThroughput[k] / 1e6 << " Mbps"
+                  << std::endl;
+    }
+    if (!summaryFile.empty ())
+    {
+        completionSummary.Save (summaryFile);
+    }
+    if (cache.IsEnabled ())
+    {
+        // This run alone, for merging into --summaryFile on a cache hit
+        completionSummary.Save (cache.GetEntryFile ("summary"));
+    }
+
+    Simulator::Destroy ();
+    cache.Store ();
+    return 0;
+}
@@ -0,0 +1,85 @@
+#include "ns3/core-module.h"
+
+#include "scenario-log.h"
+
+#include <chrono>
+#include <iostream>
+#include <streambuf>
+
+using namespace ns3;
+
+// Per-site cost of the scenario logging, compiled out versus compiled in with
+// its category off or recording into the ring, next to ns-3 component logging
+// (which is itself compiled out in optimized builds):
+//   ./ns3 run "scratch/log-bench --iterations=50000000"
+
+NS_LOG_COMPONENT_DEFINE ("LogBench");
+
+// Discards whatever NS_LOG formats, so only the formatting is measured
+class NullBuffer : public std::streambuf
+{
+protected:
+    int overflow (int c) override
+    {
+        return c;
+    }
+};
+
+// The same loop body at any compile-time ceiling: a Debug site with two arguments
+template <int MaxLevel>
+uint64_t ScenarioLoop (uint64_t iterations)
+{
+    uint64_t acc = 0;
+    for (uint64_t i = 0; i < iterations; ++i)
+    {
+        acc = acc * 6364136223846793005ULL + i;
+        SCENARIO_LOG_GATED (MaxLevel, Debug, Mac, "iteration %u state %x", i, acc);
+    }
+    return acc;
+}
+
+uint64_t ComponentLoop (uint64_t iterations)
+{
+    uint64_t acc = 0;
+    for (uint64_t i = 0; i < iterations; ++i)
+    {
+        acc = acc * 6364136223846793005ULL + i;
+        NS_LOG_DEBUG ("iteration " << i << " state " << acc);
+    }
+    return acc;
+}
+
+template <typename F>
+void Measure (const std::string &label, uint64_t iterations, F loop)
+{
+    auto start = std::chrono::steady_clock::now ();
+    volatile uint64_t sink = loop (iterations);
+    (void) sink;
+    double seconds = std::chrono::duration<double> (std::chrono::steady_clock::now () - start).count ();
+    std::cout << label << " " << seconds * 1e9 / iterations << " ns/iteration" << std::endl;
+}
+
+int main (int argc, char *argv[])
+{
+    uint64_t iterations = 20000000;
+
+    CommandLine cmd;
+    cmd.AddValue ("iterations", "Loop iterations per measurement", iterations);
+    cmd.Parse (argc, argv);
+
+    Measure ("scenario log compiled out         ", iterations, ScenarioLoop<0>);
+    Measure ("scenario log compiled in, disabled", iterations, ScenarioLoop<4>);
+
+    Measure ("ns-3 NS_LOG, component disabled   ", iterations, ComponentLoop);
+    NullBuffer null;
+    std::streambuf *saved = std::clog.rdbuf (&null);
+    LogComponentEnable ("LogBench", LOG_LEVEL_DEBUG);
+    Measure ("ns-3 NS_LOG, component enabled    ", iterations, ComponentLoop);
+    LogComponentDisable ("LogBench", LOG_LEVEL_ALL);
+    std::clog.rdbuf (saved);
+
+    // Last, since it installs the dump-at-exit handler
+    ScenarioLog::Get ().Start ("Mac", "log-bench.bin");
+    Measure ("scenario log compiled in, to ring ", iterations, ScenarioLoop<4>);
+    return 0;
+}
@@ -0,0 +1,135 @@
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/mobility-module.h"
+#include "ns3/propagation-module.h"
+
+#include "client-mobility.h"
+#include "placement.h"
+#include "random-streams.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <vector>
+
+using namespace ns3;
+
+// Per-frame cost of the position-dependent channel work, the loss chain of
+// parts d and e (log-distance, then Nakagami) and the propagation delay, as
+// YansWifiChannel::Send does it for every receiver of an AP frame. Two client
+// sets start from the same layout, one static and one with the given
+// mobility, and every frame is sent to both, in alternating order:
+//   ./ns3 run "scratch/loss-bench --clients=100 --mobility=waypoint --maxSpeed=2"
+
+struct ClientSet
+{
+    NodeContainer nodes;
+    std::vector<Ptr<MobilityModel>> models;
+    int64_t ns = 0;
+};
+
+Ptr<MobilityModel> g_ap;
+Ptr<PropagationLossModel> g_loss;
+Ptr<PropagationDelayModel> g_delay;
+uint64_t g_frames = 0;
+double g_sum = 0;
+
+void SendTo (ClientSet &set)
+{
+    auto start = std::chrono::steady_clock::now ();
+    for (const Ptr<MobilityModel> &model : set.models)
+    {
+        g_sum += g_loss->CalcRxPower (20.0, g_ap, model) + g_delay->GetDelay (g_ap, model).GetDouble ();
+    }
+    set.ns += std::chrono::duration_cast<std::chrono::nanoseconds> (std::chrono::steady_clock::now () - start).count ();
+}
+
+void SendFrame (ClientSet *fixed, ClientSet *moving, Time interval)
+{
+    if (g_frames++ % 2)
+    {
+        SendTo (*fixed);
+        SendTo (*moving);
+    }
+    else
+    {
+        SendTo (*moving);
+        SendTo (*fixed);
+    }
+    Simulator::Schedule (interval, &SendFrame, fixed, moving, interval);
+}
+
+int main (int argc, char *argv[])
+{
+    uint32_t clients = 100;
+    PlacementParameters placement;
+    placement.layout = "disk";
+    placement.radius = 15.0;
+    MobilityParameters clientMobility;
+    clientMobility.model = "waypoint";
+    Time interval = MilliSeconds (1);
+    double duration = 60.0;
+
+    CommandLine cmd;
+    cmd.AddValue ("clients", "Clients in each set", clients);
+    cmd.AddValue ("placement", "Client layout: ring, line, grid, hex, disk, poisson or clusters", placement.layout);
+    cmd.AddValue ("radius", "Radius (m) of the ring, or of the disk the random layouts fill", placement.radius);
+    cmd.AddValue ("mobility", "Mobility of the moving set: waypoint, gaussMarkov or trace", clientMobility.model);
+    cmd.AddValue ("minSpeed", "Minimum client speed (m/s) for waypoint and gaussMarkov", clientMobility.minSpeed);
+    cmd.AddValue ("maxSpeed", "Maximum client speed (m/s) for waypoint and gaussMarkov", clientMobility.maxSpeed);
+    cmd.AddValue ("pause", "Pause (s) at each waypoint", clientMobility.pause);
+    cmd.AddValue ("mobilityTrace", "ns-2 movement file for mobility=trace", clientMobility.traceFile);
+    cmd.AddValue ("interval", "Time between AP frames", interval);
+    cmd.AddValue ("duration", "Simulated time (s)", duration);
+    cmd.Parse (argc, argv);
+
+    NodeContainer ap;
+    ap.Create (1);
+    MobilityHelper mobilityAp;
+    mobilityAp.SetMobilityModel ("ns3::ConstantPositionMobilityModel");
+    mobilityAp.Install (ap);
+    g_ap = ap.Get (0)->GetObject<MobilityModel> ();
+
+    // Same layout for both sets
+    ClientSet fixed;
+    ClientSet moving;
+    MobilityParameters staticMobility;
+    fixed.nodes.Create (clients);
+    moving.nodes.Create (clients);
+    InstallClientMobility (fixed.nodes,
+                           PlacementGenerator (placement, StreamIndex (RandomSubsystem::Placement, 0)).CreateAllocator (clients),
+                           staticMobility, placement.radius);
+    InstallClientMobility (moving.nodes,
+                           PlacementGenerator (placement, StreamIndex (RandomSubsystem::Placement, 0)).CreateAllocator (clients),
+                           clientMobility, placement.radius);
+    AssignClientMobilityStreams (moving.nodes);
+    for (ClientSet *set : {&fixed, &moving})
+    {
+        for (uint32_t i = 0; i < clients; ++i)
+        {
+            set->models.push_back (set->nodes.Get (i)->GetObject<MobilityModel> ());
+        }
+    }
+
+    g_loss = CreateObjectWithAttributes<LogDistancePropagationLossModel> ("Exponent", DoubleValue (4.0));
+    g_loss->SetNext (CreateObjectWithAttributes<NakagamiPropagationLossModel> (
+        "m0", DoubleValue (0.5), "m1", DoubleValue (0.75), "m2", DoubleValue (1.0)));
+    g_delay = CreateObject<ConstantSpeedPropagationDelayModel> ();
+
+    Simulator::Schedule (interval, &SendFrame, &fixed, &moving, interval);
+    Simulator::Stop (Seconds (duration));
+    Simulator::Run ();
+
+    // Every event that is not a frame is a mobility model's course change or velocity update
+    uint64_t mobilityEvents = Simulator::GetEventCount () - g_frames;
+    volatile double sink = g_sum;
+    (void) sink;
+    std::cout << g_frames << " frames to " << clients << " clients in each set, " << mobilityEvents
+              << " mobility events" << std::endl;
+    std::cout << "static: " << double (fixed.ns) / g_frames << " ns/frame" << std::endl;
+    std::cout << clientMobility.model << ": " << double (moving.ns) / g_frames << " ns/frame, "
+              << double (moving.ns) / std::max<int64_t> (fixed.ns, 1) << "x static" << std::endl;
+
+    Simulator::Destroy ();
+    return 0;
+}
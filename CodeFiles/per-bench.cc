@@ -0,0 +1,102 @@
+#include "ns3/core-module.h"
+#include "ns3/wifi-module.h"
+
+#include "per-table.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+using namespace ns3;
+
+// Cost per chunk success rate query of an exact error-rate model and of its
+// TabulatedErrorRateModel, and the largest difference between the two, over
+// random HT MCS 0-7 queries spanning the waterfall region:
+//   ./ns3 run "scratch/per-bench --model=ns3::NistErrorRateModel --stepDb=0.05"
+
+struct Query
+{
+    uint8_t mcs;
+    double snr;
+    uint64_t nbits;
+};
+
+template <typename F>
+double Measure (const std::vector<Query> &queries, F query)
+{
+    double sum = 0;
+    auto start = std::chrono::steady_clock::now ();
+    for (const Query &q : queries)
+    {
+        sum += query (q);
+    }
+    double seconds = std::chrono::duration<double> (std::chrono::steady_clock::now () - start).count ();
+    volatile double sink = sum;
+    (void) sink;
+    return seconds * 1e9 / queries.size ();
+}
+
+int main (int argc, char *argv[])
+{
+    std::string model = "ns3::NistErrorRateModel";
+    double stepDb = 0.05;
+    uint32_t queries = 2000000;
+
+    CommandLine cmd;
+    cmd.AddValue ("model", "Exact ErrorRateModel type", model);
+    cmd.AddValue ("stepDb", "SNR grid step of the tables (dB)", stepDb);
+    cmd.AddValue ("queries", "Random queries per measurement", queries);
+    cmd.Parse (argc, argv);
+
+    std::vector<WifiMode> modes;
+    std::vector<WifiTxVector> txVectors;
+    for (uint8_t mcs = 0; mcs < 8; ++mcs)
+    {
+        modes.push_back (HtPhy::GetHtMcs (mcs));
+        txVectors.emplace_back (modes.back (), 0, WIFI_PREAMBLE_HT_MF, 800, 1, 1, 0, 20, false);
+    }
+
+    // SNR uniform over -5..35 dB, sizes from an ACK to a large A-MPDU chunk
+    Ptr<UniformRandomVariable> uniform = CreateObject<UniformRandomVariable> ();
+    std::vector<Query> list;
+    list.reserve (queries);
+    for (uint32_t i = 0; i < queries; ++i)
+    {
+        double snrDb = uniform->GetValue (-5.0, 35.0);
+        list.push_back ({static_cast<uint8_t> (uniform->GetInteger (0, 7)), std::pow (10.0, snrDb / 10.0),
+                         uniform->GetInteger (112, 64000)});
+    }
+
+    ObjectFactory factory (model);
+    Ptr<ErrorRateModel> exact = factory.Create<ErrorRateModel> ();
+    Ptr<ErrorRateModel> tabulated = CreateObjectWithAttributes<TabulatedErrorRateModel> (
+        "ExactModel", StringValue (model), "StepDb", DoubleValue (stepDb));
+
+    auto exactQuery = [&] (const Query &q) {
+        return exact->GetChunkSuccessRate (modes[q.mcs], txVectors[q.mcs], q.snr, q.nbits);
+    };
+    auto tabulatedQuery = [&] (const Query &q) {
+        return tabulated->GetChunkSuccessRate (modes[q.mcs], txVectors[q.mcs], q.snr, q.nbits);
+    };
+
+    auto buildStart = std::chrono::steady_clock::now ();
+    double maxError = 0;
+    double sumError = 0;
+    for (const Query &q : list)
+    {
+        double error = std::abs (tabulatedQuery (q) - exactQuery (q));
+        maxError = std::max (maxError, error);
+        sumError += error;
+    }
+    double buildSeconds = std::chrono::duration<double> (std::chrono::steady_clock::now () - buildStart).count ();
+
+    std::cout << model << ", " << stepDb << " dB grid" << std::endl;
+    std::cout << "exact     " << Measure (list, exactQuery) << " ns/query" << std::endl;
+    std::cout << "tabulated " << Measure (list, tabulatedQuery) << " ns/query" << std::endl;
+    std::cout << "success rate error max " << maxError << " mean " << sumError / list.size () << std::endl;
+    std::cout << "accuracy pass with table builds " << buildSeconds << " s" << std::endl;
+    TabulatedErrorRateModel::Report (std::cout);
+    return 0;
+}
@@ -0,0 +1,199 @@
+#ifndef PER_TABLE_H
+#define PER_TABLE_H
+
+#include "ns3/core-module.h"
+#include "ns3/wifi-module.h"
+
+#include <cmath>
+#include <cstdint>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using namespace ns3;
+
+// Error-rate model that answers chunk success rate queries from tables of an
+// exact model (ExactModel) instead of evaluating its erfc and code-bound
+// series per frame. A table holds ln(success rate) of a reference chunk over
+// a dense SNR grid for one (mode, PPDU field, size bucket); size buckets are
+// powers of two, the reference chunk is the bucket's upper bound, and a
+// chunk of n bits is answered as exp (n / ref * ln rate), which is exact for
+// models of independent bit errors (NIST, Yans) and interpolated linearly in
+// dB between grid points. The exact model must depend only on the mode,
+// field, SNR and chunk size, as the ns-3 AWGN models do.
+//
+// Accuracy, per exact model (the interpolation error falls with the square
+// of StepDb; SNRs outside [MinSnrDb, MaxSnrDb] go to the exact model):
+//   NIST        size scaling exact; at the default 0.05 dB the success rate
+//               of HT MCS 0-7 is within 2e-3 of the exact model for 14 to
+//               8000-byte chunks (worst near the BPSK waterfall for short
+//               chunks), 7e-3 at 0.1 dB
+//   Yans        size scaling exact; interpolation error of the same kind,
+//               not measured here (per-bench measures it)
+//   TableBased  refused: it switches reference frame size at SizeThreshold
+//               (400 bytes) and truncates chunks to whole bytes, so a chunk's
+//               rate is not a power of its bucket's reference rate
+//
+// A table is built on first use, from ExactModel's defaults, and shared by
+// every PHY using the same ExactModel and grid, so a run builds each table once.
+class TabulatedErrorRateModel : public ErrorRateModel
+{
+public:
+    static TypeId GetTypeId ()
+    {
+        static TypeId tid = TypeId ("ns3::TabulatedErrorRateModel")
+                                .SetParent<ErrorRateModel> ()
+                                .SetGroupName ("Wifi")
+                                .AddConstructor<TabulatedErrorRateModel> ()
+                                .AddAttribute ("ExactModel",
+                                               "ErrorRateModel type the tables are built from",
+                                               StringValue ("ns3::NistErrorRateModel"),
+                                               MakeStringAccessor (&TabulatedErrorRateModel::m_exactName),
+                                               MakeStringChecker ())
+                                .AddAttribute ("MinSnrDb", "Lowest tabulated SNR (dB)",
+                                               DoubleValue (-10.0),
+                                               MakeDoubleAccessor (&TabulatedErrorRateModel::m_minDb),
+                                               MakeDoubleChecker<double> ())
+                                .AddAttribute ("MaxSnrDb", "Highest tabulated SNR (dB)",
+                                               DoubleValue (50.0),
+                                               MakeDoubleAccessor (&TabulatedErrorRateModel::m_maxDb),
+                                               MakeDoubleChecker<double> ())
+                                .AddAttribute ("StepDb", "SNR grid step (dB)",
+                                               DoubleValue (0.05),
+                                               MakeDoubleAccessor (&TabulatedErrorRateModel::m_stepDb),
+                                               MakeDoubleChecker<double> (0.001));
+        return tid;
+    }
+
+    bool IsAwgn () const override
+    {
+        return Exact ()->IsAwgn ();
+    }
+
+    int64_t AssignStreams (int64_t stream) override
+    {
+        return Exact ()->AssignStreams (stream);
+    }
+
+    // Queries and table builds over all instances
+    static void Report (std::ostream &os)
+    {
+        const Stats &stats = GetStats ();
+        os << "PER tables: " << stats.tables << " built, " << stats.queries << " queries, "
+           << stats.exact << " exact evaluations" << std::endl;
+    }
+
+private:
+    struct Table
+    {
+        uint64_t refBits;
+        std::vector<double> lnRate;
+    };
+
+    struct Stats
+    {
+        uint64_t tables = 0;
+        uint64_t queries = 0;
+        uint64_t exact = 0; // including those made building tables
+    };
+
+    static Stats &GetStats ()
+    {
+        static Stats stats;
+        return stats;
+    }
+
+    // Tables of every instance, by exact model and grid
+    static std::unordered_map<std::string, std::unordered_map<uint64_t, Table>> &SharedTables ()
+    {
+        static std::unordered_map<std::string, std::unordered_map<uint64_t, Table>> tables;
+        return tables;
+    }
+
+    Ptr<ErrorRateModel> Exact () const
+    {
+        if (!m_exact)
+        {
+            ObjectFactory factory (m_exactName);
+            m_exact = factory.Create<ErrorRateModel> ();
+            if (!m_exact)
+            {
+                NS_FATAL_ERROR (m_exactName << " is not an ErrorRateModel");
+            }
+            if (DynamicCast<TableBasedErrorRateModel> (m_exact))
+            {
+                NS_FATAL_ERROR ("TabulatedErrorRateModel cannot reproduce " << m_exactName
+                                << "'s chunk size scaling; tabulate NIST or Yans instead");
+            }
+            std::ostringstream key;
+            key << m_exactName << " " << m_minDb << " " << m_maxDb << " " << m_stepDb;
+            m_tables = &SharedTables ()[key.str ()];
+        }
+        return m_exact;
+    }
+
+    double DoGetChunkSuccessRate (WifiMode mode, const WifiTxVector &txVector, double snr, uint64_t nbits,
+                                  uint8_t numRxAntennas, WifiPpduField field, uint16_t staId) const override
+    {
+        Stats &stats = GetStats ();
+        stats.queries++;
+        Ptr<ErrorRateModel> exact = Exact ();
+        double snrDb = 10.0 * std::log10 (snr);
+        if (nbits == 0 || !(snrDb >= m_minDb && snrDb < m_maxDb))
+        {
+            stats.exact++;
+            return exact->GetChunkSuccessRate (mode, txVector, snr, nbits, numRxAntennas, field, staId);
+        }
+
+        uint32_t bucket = 64 - __builtin_clzll ((nbits - 1) | 1);
+        uint64_t key = uint64_t (mode.GetUid ()) << 16 | uint64_t (field) << 8 | bucket;
+        auto it = m_tables->find (key);
+        if (it == m_tables->end ())
+        {
+            it = m_tables->emplace (key, Build (exact, mode, txVector, uint64_t (1) << bucket, numRxAntennas, field, staId)).first;
+        }
+        const Table &table = it->second;
+
+        double position = (snrDb - m_minDb) / m_stepDb;
+        std::size_t i = static_cast<std::size_t> (position);
+        if (i + 1 >= table.lnRate.size ())
+        {
+            i = table.lnRate.size () - 2;
+        }
+        double fraction = position - i;
+        double lnRate = table.lnRate[i] + (table.lnRate[i + 1] - table.lnRate[i]) * fraction;
+        return std::exp (lnRate * nbits / table.refBits);
+    }
+
+    Table Build (Ptr<ErrorRateModel> exact, WifiMode mode, const WifiTxVector &txVector, uint64_t refBits,
+                 uint8_t numRxAntennas, WifiPpduField field, uint16_t staId) const
+    {
+        Stats &stats = GetStats ();
+        Table table {refBits, {}};
+        std::size_t points = static_cast<std::size_t> (std::ceil ((m_maxDb - m_minDb) / m_stepDb)) + 1;
+        table.lnRate.reserve (points);
+        for (std::size_t i = 0; i < points; ++i)
+        {
+            double snr = std::pow (10.0, (m_minDb + i * m_stepDb) / 10.0);
+            double rate = exact->GetChunkSuccessRate (mode, txVector, snr, refBits, numRxAntennas, field, staId);
+            // About ln of the smallest double, so a zero rate comes back as zero
+            table.lnRate.push_back (rate > 0 ? std::log (rate) : -745.0);
+        }
+        stats.exact += points;
+        stats.tables++;
+        return table;
+    }
+
+    std::string m_exactName = "ns3::NistErrorRateModel";
+    double m_minDb = -10.0;
+    double m_maxDb = 50.0;
+    double m_stepDb = 0.05;
+    mutable Ptr<ErrorRateModel> m_exact;
+    mutable std::unordered_map<uint64_t, Table> *m_tables = nullptr;
+};
+
+NS_OBJECT_ENSURE_REGISTERED (TabulatedErrorRateModel);
+
+#endif // PER_TABLE_H
@@ -0,0 +1,65 @@
+#ifndef PHY_TIER_H
+#define PHY_TIER_H
+
+#include "ns3/core-module.h"
+#include "ns3/propagation-module.h"
+#include "ns3/spectrum-module.h"
+#include "ns3/wifi-module.h"
+
+#include <string>
+
+using namespace ns3;
+
+// How much of the PHY a scenario simulates (--phyTier), cheapest first:
+//
+//   yans      YansWifiPhy, one scalar power per frame (the original PHY)
+//   spectrum  SpectrumWifiPhy on a MultiModelSpectrumChannel carrying the same
+//             loss models, so power is tracked per band and frames on
+//             overlapping channels interfere in proportion to their overlap
+//
+// Every tier uses the same propagation loss objects, so fading draws from
+// the same streams and runs stay comparable across tiers.
+class PhyTier
+{
+public:
+    // The loss and delay models are taken from the Yans channel, which the
+    // spectrum tier then leaves unused
+    PhyTier (const std::string &tier, Ptr<YansWifiChannel> channel)
+        : m_tier (tier)
+    {
+        if (tier == "yans")
+        {
+            m_yans.SetChannel (channel);
+            return;
+        }
+        if (tier != "spectrum")
+        {
+            NS_FATAL_ERROR ("Unknown PHY tier " << tier << " (yans or spectrum)");
+        }
+
+        PointerValue loss;
+        channel->GetAttribute ("PropagationLossModel", loss);
+        PointerValue delay;
+        channel->GetAttribute ("PropagationDelayModel", delay);
+        Ptr<MultiModelSpectrumChannel> spectrumChannel = CreateObject<MultiModelSpectrumChannel> ();
+        spectrumChannel->AddPropagationLossModel (loss.Get<PropagationLossModel> ());
+        spectrumChannel->SetPropagationDelayModel (delay.Get<PropagationDelayModel> ());
+        m_spectrum.SetChannel (spectrumChannel);
+    }
+
+    WifiPhyHelper &GetHelper ()
+    {
+        if (m_tier == "spectrum")
+        {
+            return m_spectrum;
+        }
+        return m_yans;
+    }
+
+private:
+    std::string m_tier;
+    YansWifiPhyHelper m_yans;
+    SpectrumWifiPhyHelper m_spectrum;
+};
+
+#endif // PHY_TIER_H
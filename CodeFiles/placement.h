@@ -0,0 +1,268 @@
+#ifndef PLACEMENT_H
+#define PLACEMENT_H
+
+#include "ns3/core-module.h"
+#include "ns3/mobility-module.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using namespace ns3;
+
+// Client layouts around the AP at the origin. Every generator is linear in the
+// number of clients (Poisson-disk in expectation), so 10^5 nodes take well
+// under a second, and the random ones draw from the given stream so a layout
+// is reproduced exactly for the same RngSeed/RngRun (stream -1 leaves the
+// stream to automatic assignment).
+//
+//   ring      evenly on a circle of the given radius (the original layout)
+//   line      along +x, the first client spacing away from the AP
+//   grid      square grid of the given spacing centred on the AP
+//   hex       hexagonal lattice filled ring by ring outwards from the AP
+//   disk      uniform over a disk of the given radius
+//   poisson   uniform over the disk, but no two nodes (AP included) closer than minSeparation
+//   clusters  Gaussian hotspots of clusterSpread around centres uniform over the disk
+struct PlacementParameters
+{
+    std::string layout = "ring";
+    double radius = 5.0;
+    double spacing = 5.0;
+    double minSeparation = 1.0;
+    uint32_t clusters = 4;
+    double clusterSpread = 2.0;
+};
+
+class PlacementGenerator
+{
+public:
+    PlacementGenerator (const PlacementParameters &params, int64_t stream)
+        : m_params (params),
+          m_uniform (CreateObject<UniformRandomVariable> ()),
+          m_normal (CreateObject<NormalRandomVariable> ())
+    {
+        if (stream >= 0)
+        {
+            m_uniform->SetStream (stream);
+            m_normal->SetStream (stream + 1);
+        }
+    }
+
+    std::vector<Vector> Generate (uint32_t n)
+    {
+        const std::string &layout = m_params.layout;
+        if (layout == "ring")
+        {
+            return Ring (n);
+        }
+        if (layout == "line")
+        {
+            return Line (n);
+        }
+        if (layout == "grid")
+        {
+            return Grid (n);
+        }
+        if (layout == "hex")
+        {
+            return Hex (n);
+        }
+        if (layout == "disk")
+        {
+            return Disk (n);
+        }
+        if (layout == "poisson")
+        {
+            return PoissonDisk (n);
+        }
+        if (layout == "clusters")
+        {
+            return Clusters (n);
+        }
+        NS_FATAL_ERROR ("Unknown placement " << layout << " (ring, line, grid, hex, disk, poisson or clusters)");
+    }
+
+    // Convenience for MobilityHelper::SetPositionAllocator
+    Ptr<ListPositionAllocator> CreateAllocator (uint32_t n)
+    {
+        Ptr<ListPositionAllocator> alloc = CreateObject<ListPositionAllocator> ();
+        for (const Vector &position : Generate (n))
+        {
+            alloc->Add (position);
+        }
+        return alloc;
+    }
+
+private:
+    std::vector<Vector> Ring (uint32_t n)
+    {
+        std::vector<Vector> positions;
+        positions.reserve (n);
+        for (uint32_t i = 0; i < n; ++i)
+        {
+            double angle = i * (2.0 * M_PI / n);
+            positions.emplace_back (m_params.radius * std::cos (angle), m_params.radius * std::sin (angle), 0.0);
+        }
+        return positions;
+    }
+
+    std::vector<Vector> Line (uint32_t n)
+    {
+        std::vector<Vector> positions;
+        positions.reserve (n);
+        for (uint32_t i = 0; i < n; ++i)
+        {
+            positions.emplace_back ((i + 1) * m_params.spacing, 0.0, 0.0);
+        }
+        return positions;
+    }
+
+    // Row-major over the smallest square that holds n + 1 points, skipping the AP's
+    std::vector<Vector> Grid (uint32_t n)
+    {
+        uint32_t side = static_cast<uint32_t> (std::ceil (std::sqrt (n + 1.0)));
+        double offset = (side - 1) / 2.0;
+        std::vector<Vector> positions;
+        positions.reserve (n);
+        for (uint32_t i = 0; positions.size () < n; ++i)
+        {
+            double x = (i % side - offset) * m_params.spacing;
+            double y = (i / side - offset) * m_params.spacing;
+            if (std::abs (x) < 1e-9 && std::abs (y) < 1e-9)
+            {
+                continue;
+            }
+            positions.emplace_back (x, y, 0.0);
+        }
+        return positions;
+    }
+
+    // Axial coordinates, walking hexagonal ring k (6k cells) for k = 1, 2, ...
+    std::vector<Vector> Hex (uint32_t n)
+    {
+        static const int directions[6][2] = {{1, 0}, {1, -1}, {0, -1}, {-1, 0}, {-1, 1}, {0, 1}};
+        std::vector<Vector> positions;
+        positions.reserve (n);
+        for (int k = 1; positions.size () < n; ++k)
+        {
+            int q = -k;
+            int r = k;
+            for (int side = 0; side < 6 && positions.size () < n; ++side)
+            {
+                for (int step = 0; step < k && positions.size () < n; ++step)
+                {
+                    positions.emplace_back (m_params.spacing * (q + r / 2.0), m_params.spacing * r * std::sqrt (3.0) / 2.0, 0.0);
+                    q += directions[side][0];
+                    r += directions[side][1];
+                }
+            }
+        }
+        return positions;
+    }
+
+    Vector UniformInDisk (double radius)
+    {
+        double r = radius * std::sqrt (m_uniform->GetValue ());
+        double angle = 2.0 * M_PI * m_uniform->GetValue ();
+        return Vector (r * std::cos (angle), r * std::sin (angle), 0.0);
+    }
+
+    std::vector<Vector> Disk (uint32_t n)
+    {
+        std::vector<Vector> positions;
+        positions.reserve (n);
+        for (uint32_t i = 0; i < n; ++i)
+        {
+            positions.push_back (UniformInDisk (m_params.radius));
+        }
+        return positions;
+    }
+
+    // Dart throwing against a hash grid of minSeparation cells, so each
+    // candidate is checked against the few nodes in the 3x3 cells around it
+    // and memory only grows with the nodes placed
+    std::vector<Vector> PoissonDisk (uint32_t n)
+    {
+        double d = m_params.minSeparation;
+        if (d <= 0)
+        {
+            NS_FATAL_ERROR ("Poisson-disk placement needs a positive minSeparation");
+        }
+        auto cellOf = [d] (double x, double y) {
+            return std::make_pair (static_cast<int64_t> (std::floor (x / d)), static_cast<int64_t> (std::floor (y / d)));
+        };
+        auto key = [] (int64_t cx, int64_t cy) { return static_cast<uint64_t> (cx) * 0x9E3779B97F4A7C15ULL ^ static_cast<uint64_t> (cy); };
+
+        std::vector<Vector> placed = {Vector (0.0, 0.0, 0.0)}; // the AP
+        std::unordered_map<uint64_t, std::vector<uint32_t>> cells;
+        cells[key (0, 0)].push_back (0);
+
+        uint64_t attempts = 0;
+        uint64_t maxAttempts = 100ULL * n + 1000;
+        while (placed.size () < n + 1 && attempts++ < maxAttempts)
+        {
+            Vector candidate = UniformInDisk (m_params.radius);
+            auto cell = cellOf (candidate.x, candidate.y);
+            bool clear = true;
+            for (int64_t dx = -1; dx <= 1 && clear; ++dx)
+            {
+                for (int64_t dy = -1; dy <= 1 && clear; ++dy)
+                {
+                    auto it = cells.find (key (cell.first + dx, cell.second + dy));
+                    if (it == cells.end ())
+                    {
+                        continue;
+                    }
+                    for (uint32_t other : it->second)
+                    {
+                        if (CalculateDistance (candidate, placed[other]) < d)
+                        {
+                            clear = false;
+                            break;
+                        }
+                    }
+                }
+            }
+            if (clear)
+            {
+                cells[key (cell.first, cell.second)].push_back (placed.size ());
+                placed.push_back (candidate);
+            }
+        }
+        if (placed.size () < n + 1)
+        {
+            NS_FATAL_ERROR ("Only " << placed.size () - 1 << " of " << n << " clients fit " << d
+                            << " m apart within " << m_params.radius << " m; increase radius or lower minSeparation");
+        }
+        return std::vector<Vector> (placed.begin () + 1, placed.end ());
+    }
+
+    // Clients are dealt round-robin to the hotspots, so cluster sizes differ by at most one
+    std::vector<Vector> Clusters (uint32_t n)
+    {
+        uint32_t k = std::max<uint32_t> (m_params.clusters, 1);
+        std::vector<Vector> centres;
+        for (uint32_t i = 0; i < k; ++i)
+        {
+            centres.push_back (UniformInDisk (m_params.radius));
+        }
+        std::vector<Vector> positions;
+        positions.reserve (n);
+        for (uint32_t i = 0; i < n; ++i)
+        {
+            const Vector &centre = centres[i % k];
+            positions.emplace_back (centre.x + m_params.clusterSpread * m_normal->GetValue (),
+                                    centre.y + m_params.clusterSpread * m_normal->GetValue (), 0.0);
+        }
+        return positions;
+    }
+
+    PlacementParameters m_params;
+    Ptr<UniformRandomVariable> m_uniform;
+    Ptr<NormalRandomVariable> m_normal;
+};
+
+#endif // PLACEMENT_H
@@ -0,0 +1,296 @@
+#ifndef POOLED_ALLOC_H
+#define POOLED_ALLOC_H
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+
+#include <sys/mman.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <ostream>
+
+using namespace ns3;
+
+// Size-class free-list pools behind the program's operator new/delete. The
+// packet path (Packet objects, Buffer data, header and trailer chunks,
+// PacketMetadata and ByteTagList data, tags, events and the Ptr-managed
+// objects around them) allocates and frees the same few small sizes for
+// every segment on every hop. With the pools on, blocks of up to kMaxPooled
+// bytes come from per-thread free lists of 16-byte size classes, refilled
+// from 64 KiB chunks of one class each, carved from an address range
+// reserved at Enable and never returned. A block is known to be pooled by
+// its address, and its class by its chunk's, so blocks carry no header and
+// may be freed on any thread. Larger blocks, blocks allocated before Enable
+// and every block while the pools are off go to malloc.
+// PacketTagList allocates with malloc directly and is not pooled.
+//
+// The replacement operators are defined in the program with
+// POOLED_ALLOCATION_DEFINE (). With the pools and the counters off (the
+// default) they call malloc and free directly, after one range test in
+// delete; the counters cost a thread-local update per call and only run
+// after EnableCounters.
+class PooledAllocator
+{
+public:
+    static constexpr std::size_t kGranule = 16;
+    static constexpr std::size_t kMaxPooled = 1024;
+    static constexpr std::size_t kClasses = kMaxPooled / kGranule;
+    static constexpr std::size_t kChunkBytes = 64 * 1024;
+    // Address space only; pages are committed as chunks are used
+    static constexpr std::size_t kArenaBytes = std::size_t (4) << 30;
+
+    struct Counters
+    {
+        uint64_t allocations = 0;
+        uint64_t frees = 0;
+        uint64_t bytes = 0;
+        uint64_t pooled = 0;     // allocations served from a free list or chunk
+        uint64_t chunkBytes = 0; // taken from the arena for the pools
+    };
+
+    // Before the run's allocations, on the main thread
+    static void Enable ()
+    {
+        Arena &arena = GetArena ();
+        if (arena.base)
+        {
+            return;
+        }
+        void *base = mmap (nullptr, kArenaBytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+        if (base == MAP_FAILED)
+        {
+            return; // stays on malloc
+        }
+        arena.base = static_cast<char *> (base);
+        arena.end = arena.base + kArenaBytes;
+        Flags () |= kPool;
+    }
+
+    static void EnableCounters ()
+    {
+        Flags () |= kCount;
+    }
+
+    // Counts of the calling thread since EnableCounters
+    static Counters GetCounters ()
+    {
+        return Thread ().counters;
+    }
+
+    static void Report (std::ostream &os, const Counters &since)
+    {
+        Counters now = GetCounters ();
+        os << "Allocations: " << now.allocations - since.allocations << " new, " << now.frees - since.frees
+           << " delete, " << (now.bytes - since.bytes) / 1048576.0 << " MiB requested, "
+           << now.pooled - since.pooled << " pooled, " << now.chunkBytes / 1048576.0 << " MiB in pools" << std::endl;
+    }
+
+    static void *Allocate (std::size_t size)
+    {
+        unsigned flags = Flags ();
+        if (flags == 0)
+        {
+            return Malloc (size);
+        }
+        ThreadState &state = Thread ();
+        if (flags & kCount)
+        {
+            state.counters.allocations++;
+            state.counters.bytes += size;
+        }
+        std::size_t cls = (size + kGranule - 1) / kGranule;
+        if (!(flags & kPool) || cls > kClasses)
+        {
+            return Malloc (size);
+        }
+        cls = cls == 0 ? 1 : cls;
+        state.counters.pooled += (flags & kCount) != 0;
+        FreeBlock *block = state.free[cls];
+        if (block)
+        {
+            state.free[cls] = block->next;
+            return block;
+        }
+        return Carve (state, cls);
+    }
+
+    static void Free (void *p)
+    {
+        const Arena &arena = GetArena ();
+        char *address = static_cast<char *> (p);
+        bool pooled = address >= arena.base && address < arena.end;
+        if ((Flags () & kCount) && p)
+        {
+            Thread ().counters.frees++;
+        }
+        if (!pooled)
+        {
+            std::free (p);
+            return;
+        }
+        std::size_t cls = ChunkClasses ()[(address - arena.base) / kChunkBytes];
+        ThreadState &state = Thread ();
+        FreeBlock *block = static_cast<FreeBlock *> (p);
+        block->next = state.free[cls];
+        state.free[cls] = block;
+    }
+
+private:
+    static constexpr unsigned kPool = 1;
+    static constexpr unsigned kCount = 2;
+
+    // A free block holds the list link
+    struct FreeBlock
+    {
+        FreeBlock *next;
+    };
+
+    struct Arena
+    {
+        char *base;
+        char *end;
+        std::atomic<std::size_t> used;
+    };
+
+    struct ThreadState
+    {
+        FreeBlock *free[kClasses + 1];
+        char *chunk[kClasses + 1];
+        std::size_t chunkLeft[kClasses + 1];
+        Counters counters;
+    };
+
+    // Constant-initialized, so usable from the first allocation on
+    static unsigned &Flags ()
+    {
+        static unsigned flags = 0;
+        return flags;
+    }
+
+    static Arena &GetArena ()
+    {
+        static Arena arena {nullptr, nullptr, {0}};
+        return arena;
+    }
+
+    // Size class of each arena chunk
+    static uint8_t *ChunkClasses ()
+    {
+        static uint8_t classes[kArenaBytes / kChunkBytes];
+        return classes;
+    }
+
+    static ThreadState &Thread ()
+    {
+        static thread_local ThreadState state {};
+        return state;
+    }
+
+    static void *Malloc (std::size_t size)
+    {
+        void *p = std::malloc (size ? size : 1);
+        if (!p)
+        {
+            throw std::bad_alloc ();
+        }
+        return p;
+    }
+
+    static void *Carve (ThreadState &state, std::size_t cls)
+    {
+        std::size_t blockBytes = cls * kGranule;
+        if (state.chunkLeft[cls] < blockBytes)
+        {
+            Arena &arena = GetArena ();
+            std::size_t offset = arena.used.fetch_add (kChunkBytes, std::memory_order_relaxed);
+            if (offset + kChunkBytes > kArenaBytes)
+            {
+                return Malloc (blockBytes); // arena exhausted
+            }
+            ChunkClasses ()[offset / kChunkBytes] = cls;
+            state.chunk[cls] = arena.base + offset;
+            state.chunkLeft[cls] = kChunkBytes;
+            state.counters.chunkBytes += kChunkBytes;
+        }
+        void *block = state.chunk[cls];
+        state.chunk[cls] += blockBytes;
+        state.chunkLeft[cls] -= blockBytes;
+        return block;
+    }
+};
+
+// Replaces the program's allocation functions; use once, at file scope of
+// the program's main file. Aligned (over-aligned) new keeps the default.
+#define POOLED_ALLOCATION_DEFINE()                                                                 \
+    void *operator new (std::size_t size) { return PooledAllocator::Allocate (size); }            \
+    void *operator new[] (std::size_t size) { return PooledAllocator::Allocate (size); }          \
+    void *operator new (std::size_t size, const std::nothrow_t &) noexcept                         \
+    {                                                                                              \
+        try { return PooledAllocator::Allocate (size); } catch (...) { return nullptr; }          \
+    }                                                                                              \
+    void *operator new[] (std::size_t size, const std::nothrow_t &) noexcept                       \
+    {                                                                                              \
+        try { return PooledAllocator::Allocate (size); } catch (...) { return nullptr; }          \
+    }                                                                                              \
+    void operator delete (void *p) noexcept { PooledAllocator::Free (p); }                         \
+    void operator delete[] (void *p) noexcept { PooledAllocator::Free (p); }                       \
+    void operator delete (void *p, std::size_t) noexcept { PooledAllocator::Free (p); }            \
+    void operator delete[] (void *p, std::size_t) noexcept { PooledAllocator::Free (p); }          \
+    void operator delete (void *p, const std::nothrow_t &) noexcept { PooledAllocator::Free (p); } \
+    void operator delete[] (void *p, const std::nothrow_t &) noexcept { PooledAllocator::Free (p); }
+
+// --allocPool and --packetMetadata. Registered on the plain CommandLine:
+// neither changes results, only how fast they come.
+class AllocationMode
+{
+public:
+    void AddOptions (CommandLine &cmd)
+    {
+        cmd.AddValue ("allocPool", "Serve small allocations from size-class free-list pools", m_pool);
+        cmd.AddValue ("allocStats", "Report allocation counts over the run (to stderr)", m_stats);
+        cmd.AddValue ("packetMetadata", "Keep packet metadata for printing and checking (debugging only)", m_metadata);
+    }
+
+    // Before any packet is created
+    void Install ()
+    {
+        if (m_pool)
+        {
+            PooledAllocator::Enable ();
+        }
+        if (m_pool || m_stats)
+        {
+            PooledAllocator::EnableCounters ();
+        }
+        if (m_metadata)
+        {
+            Packet::EnablePrinting ();
+            Packet::EnableChecking ();
+        }
+    }
+
+    void Begin ()
+    {
+        m_start = PooledAllocator::GetCounters ();
+    }
+
+    void Report (std::ostream &os) const
+    {
+        if (m_pool || m_stats)
+        {
+            PooledAllocator::Report (os, m_start);
+        }
+    }
+
+private:
+    bool m_pool = false;
+    bool m_stats = false;
+    bool m_metadata = false;
+    PooledAllocator::Counters m_start;
+};
+
+#endif // POOLED_ALLOC_H
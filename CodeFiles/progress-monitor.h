@@ -0,0 +1,148 @@
+#ifndef PROGRESS_MONITOR_H
+#define PROGRESS_MONITOR_H
+
+#include "ns3/core-module.h"
+#include "ns3/applications-module.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+using namespace ns3;
+
+// Layout of the shared-memory segment a running scenario publishes its
+// progress in. The writer bumps seq to odd, updates, then bumps it to even;
+// readers copy the block and retry if seq was odd or changed (seqlock), so the
+// simulator never waits on a viewer.
+struct ProgressSegment
+{
+    static constexpr uint32_t kMagic = 0x50524f47; // "PROG"
+    static constexpr uint32_t kMaxClients = 512;
+
+    uint32_t magic;
+    uint32_t pid;
+    std::atomic<uint64_t> seq;
+    uint32_t finished;
+    uint32_t nClients;
+    double simSeconds;
+    double stopSeconds;
+    double wallSeconds;
+    uint64_t events;
+    uint64_t targetBytes;
+    uint64_t clientBytes[kMaxClients];
+};
+
+inline std::string ProgressSegmentName (const std::string &name)
+{
+    return "/ns3-progress-" + name;
+}
+
+// Publishes simulated time, executed events, per-client received bytes and
+// wall time from an event scheduled every Interval of simulated time
+class ProgressPublisher
+{
+public:
+    ~ProgressPublisher ()
+    {
+        Finish ();
+    }
+
+    // Registered on the plain CommandLine, so they stay out of the result cache key
+    void AddOptions (CommandLine &cmd)
+    {
+        cmd.AddValue ("progress", "Publish live progress in shared memory under this name (empty to disable)", m_name);
+        cmd.AddValue ("progressInterval", "Simulated seconds between progress updates", m_intervalSeconds);
+    }
+
+    bool IsEnabled () const
+    {
+        return !m_name.empty ();
+    }
+
+    void AddClient (Ptr<PacketSink> sink)
+    {
+        if (m_sinks.size () < ProgressSegment::kMaxClients)
+        {
+            m_sinks.push_back (sink);
+        }
+    }
+
+    void Start (Time stop, uint64_t targetBytes)
+    {
+        if (!IsEnabled ())
+        {
+            return;
+        }
+
+        int fd = shm_open (ProgressSegmentName (m_name).c_str (), O_CREAT | O_RDWR, 0644);
+        if (fd < 0 || ftruncate (fd, sizeof (ProgressSegment)) != 0)
+        {
+            NS_FATAL_ERROR ("Cannot create progress segment " << ProgressSegmentName (m_name));
+        }
+        void *addr = mmap (nullptr, sizeof (ProgressSegment), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        close (fd);
+        if (addr == MAP_FAILED)
+        {
+            NS_FATAL_ERROR ("Cannot map progress segment " << ProgressSegmentName (m_name));
+        }
+
+        m_segment = new (addr) ProgressSegment ();
+        m_segment->magic = ProgressSegment::kMagic;
+        m_segment->pid = getpid ();
+        m_segment->stopSeconds = stop.GetSeconds ();
+        m_segment->targetBytes = targetBytes;
+        m_segment->nClients = m_sinks.size ();
+        m_wallStart = std::chrono::steady_clock::now ();
+        Simulator::ScheduleNow (&ProgressPublisher::Publish, this);
+    }
+
+    // Last update, marks the run finished and removes the name; viewers
+    // already attached keep their mapping
+    void Finish ()
+    {
+        if (!m_segment)
+        {
+            return;
+        }
+        Update (true);
+        munmap (m_segment, sizeof (ProgressSegment));
+        shm_unlink (ProgressSegmentName (m_name).c_str ());
+        m_segment = nullptr;
+    }
+
+private:
+    void Publish ()
+    {
+        Update (false);
+        Simulator::Schedule (Seconds (m_intervalSeconds), &ProgressPublisher::Publish, this);
+    }
+
+    void Update (bool finished)
+    {
+        m_segment->seq.fetch_add (1, std::memory_order_acq_rel);
+        m_segment->simSeconds = Simulator::Now ().GetSeconds ();
+        m_segment->events = Simulator::GetEventCount ();
+        m_segment->wallSeconds =
+            std::chrono::duration<double> (std::chrono::steady_clock::now () - m_wallStart).count ();
+        for (std::size_t i = 0; i < m_sinks.size (); ++i)
+        {
+            m_segment->clientBytes[i] = m_sinks[i]->GetTotalRx ();
+        }
+        m_segment->finished = finished;
+        m_segment->seq.fetch_add (1, std::memory_order_release);
+    }
+
+    std::string m_name;
+    double m_intervalSeconds = 0.1;
+    std::vector<Ptr<PacketSink>> m_sinks;
+    ProgressSegment *m_segment = nullptr;
+    std::chrono::steady_clock::time_point m_wallStart;
+};
+
+#endif // PROGRESS_MONITOR_H
@@ -0,0 +1,138 @@
+#include "ns3/core-module.h"
+
+#include "progress-monitor.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+
+using namespace ns3;
+
+// Terminal view of a running scenario's progress segment, e.g. in a second terminal:
+//   ./ns3 run "scratch/d --numClients=40 --progress=d40"
+//   ./ns3 run "scratch/progress-viewer --name=d40"
+// Only reads the segment, so the simulation is never slowed down by it.
+
+// Copies a consistent snapshot; false while the writer is mid-update
+bool ReadSnapshot (const ProgressSegment *segment, ProgressSegment &snapshot)
+{
+    uint64_t before = segment->seq.load (std::memory_order_acquire);
+    if (before & 1)
+    {
+        return false;
+    }
+    std::memcpy (static_cast<void *> (&snapshot), segment, sizeof (ProgressSegment));
+    std::atomic_thread_fence (std::memory_order_acquire);
+    return segment->seq.load (std::memory_order_relaxed) == before;
+}
+
+void Draw (const ProgressSegment &s, double eventRate, double speed, double staleSeconds)
+{
+    double done = s.stopSeconds > 0 ? s.simSeconds / s.stopSeconds : 0.0;
+    std::cout << "\033[H\033[2J";
+    std::cout << std::fixed << std::setprecision (3)
+              << "pid " << s.pid << (s.finished ? "  finished" : "") << "\n"
+              << "simulated " << s.simSeconds << " / " << s.stopSeconds << " s (" << std::setprecision (1)
+              << 100.0 * done << " %)   wall " << s.wallSeconds << " s\n"
+              << "events " << s.events << "   " << std::setprecision (0) << eventRate << " events/s\n"
+              << std::setprecision (3) << "sim/wall " << speed << " now, "
+              << (s.wallSeconds > 0 ? s.simSeconds / s.wallSeconds : 0.0) << " overall";
+    if (speed > 0 && !s.finished)
+    {
+        std::cout << "   eta " << std::setprecision (0) << (s.stopSeconds - s.simSeconds) / speed << " s";
+    }
+    // Updates come every progressInterval of simulated time; a long gap means
+    // the simulator is crawling through that interval, or stuck in it
+    if (staleSeconds > 5.0 && !s.finished)
+    {
+        std::cout << "\nno update for " << std::setprecision (0) << staleSeconds << " s";
+    }
+    std::cout << "\n\n";
+
+    for (uint32_t i = 0; i < s.nClients && i < ProgressSegment::kMaxClients; ++i)
+    {
+        double fraction = s.targetBytes ? std::min (1.0, double (s.clientBytes[i]) / s.targetBytes) : 0.0;
+        int width = static_cast<int> (fraction * 40);
+        std::cout << "Client " << std::setw (3) << i << " [" << std::string (width, '#')
+                  << std::string (40 - width, ' ') << "] " << std::setw (10) << s.clientBytes[i] << " bytes\n";
+    }
+    std::cout << std::flush;
+}
+
+int main (int argc, char *argv[])
+{
+    std::string name = "";
+    double refresh = 0.5;
+
+    CommandLine cmd;
+    cmd.AddValue ("name", "Name the scenario was started with (--progress=name)", name);
+    cmd.AddValue ("refresh", "Seconds between screen updates", refresh);
+    cmd.Parse (argc, argv);
+
+    if (name.empty ())
+    {
+        NS_FATAL_ERROR ("Give the segment name with --name");
+    }
+
+    // The scenario may not have started yet
+    int fd = -1;
+    while ((fd = shm_open (ProgressSegmentName (name).c_str (), O_RDONLY, 0)) < 0)
+    {
+        std::cout << "\rWaiting for " << ProgressSegmentName (name) << std::flush;
+        std::this_thread::sleep_for (std::chrono::milliseconds (500));
+    }
+    void *addr = mmap (nullptr, sizeof (ProgressSegment), PROT_READ, MAP_SHARED, fd, 0);
+    close (fd);
+    if (addr == MAP_FAILED)
+    {
+        NS_FATAL_ERROR ("Cannot map " << ProgressSegmentName (name));
+    }
+    const ProgressSegment *segment = static_cast<const ProgressSegment *> (addr);
+
+    ProgressSegment snapshot;
+    ProgressSegment previous;
+    bool havePrevious = false;
+    uint64_t lastSeq = 0;
+    auto lastChange = std::chrono::steady_clock::now ();
+    while (true)
+    {
+        if (segment->magic != ProgressSegment::kMagic || !ReadSnapshot (segment, snapshot))
+        {
+            std::this_thread::sleep_for (std::chrono::milliseconds (10));
+            continue;
+        }
+
+        auto now = std::chrono::steady_clock::now ();
+        if (snapshot.seq != lastSeq)
+        {
+            lastSeq = snapshot.seq;
+            lastChange = now;
+        }
+
+        double eventRate = 0.0;
+        double speed = 0.0;
+        if (havePrevious && snapshot.wallSeconds > previous.wallSeconds)
+        {
+            double wall = snapshot.wallSeconds - previous.wallSeconds;
+            eventRate = (snapshot.events - previous.events) / wall;
+            speed = (snapshot.simSeconds - previous.simSeconds) / wall;
+        }
+        Draw (snapshot, eventRate, speed, std::chrono::duration<double> (now - lastChange).count ());
+
+        if (snapshot.finished)
+        {
+            break;
+        }
+        if (!havePrevious || snapshot.wallSeconds > previous.wallSeconds)
+        {
+            std::memcpy (static_cast<void *> (&previous), &snapshot, sizeof (ProgressSegment));
+            havePrevious = true;
+        }
+        std::this_thread::sleep_for (std::chrono::duration<double> (refresh));
+    }
+
+    munmap (addr, sizeof (ProgressSegment));
+    return 0;
+}
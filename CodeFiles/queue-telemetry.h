@@ -0,0 +1,238 @@
+#ifndef QUEUE_TELEMETRY_H
+#define QUEUE_TELEMETRY_H
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/wifi-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/traffic-control-module.h"
+#include "ns3/flow-monitor-module.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace ns3;
+
+// Short names accepted by --apQueueDisc. "Cake" is FqCobalt, the CAKE-style
+// flow-queuing scheduler with the COBALT AQM.
+inline std::string QueueDiscTypeName (const std::string &name)
+{
+    if (name == "Fifo") return "ns3::FifoQueueDisc";
+    if (name == "PfifoFast") return "ns3::PfifoFastQueueDisc";
+    if (name == "CoDel") return "ns3::CoDelQueueDisc";
+    if (name == "FqCoDel") return "ns3::FqCoDelQueueDisc";
+    if (name == "Pie") return "ns3::PieQueueDisc";
+    if (name == "FqPie") return "ns3::FqPieQueueDisc";
+    if (name == "Cobalt") return "ns3::CobaltQueueDisc";
+    if (name == "FqCobalt" || name == "Cake") return "ns3::FqCobaltQueueDisc";
+    NS_FATAL_ERROR ("Unknown queue disc " << name
+                    << " (use Default, Fifo, PfifoFast, CoDel, FqCoDel, Pie, FqPie, Cobalt or Cake)");
+    return "";
+}
+
+// Installs the selected queue disc under an mq root, one child per Wi-Fi access
+// category. Must be called after the internet stack is installed and before the
+// AP device gets its address, otherwise Ipv4AddressHelper puts ns-3's default
+// (FqCoDel) there. "Default" leaves that default in place.
+inline void InstallApQueueDisc (Ptr<NetDevice> apDevice, const std::string &name)
+{
+    if (name == "Default")
+    {
+        return;
+    }
+
+    Ptr<NetDeviceQueueInterface> ndqi = apDevice->GetObject<NetDeviceQueueInterface> ();
+    uint16_t nTxQueues = ndqi ? ndqi->GetNTxQueues () : 1;
+
+    TrafficControlHelper tch;
+    if (nTxQueues > 1)
+    {
+        uint16_t handle = tch.SetRootQueueDisc ("ns3::MqQueueDisc");
+        TrafficControlHelper::ClassIdList classes =
+            tch.AddQueueDiscClasses (handle, nTxQueues, "ns3::QueueDiscClass");
+        tch.AddChildQueueDiscs (handle, classes, QueueDiscTypeName (name));
+    }
+    else
+    {
+        tch.SetRootQueueDisc (QueueDiscTypeName (name));
+    }
+    tch.Install (apDevice);
+}
+
+// Shrinks the AP's per-AC Wi-Fi MAC queues so the backlog builds up in the queue
+// disc, where the AQM can act on it, instead of in the MAC queue.
+inline void SetApMacQueueSize (Ptr<NetDevice> apDevice, const std::string &size)
+{
+    if (size.empty ())
+    {
+        return;
+    }
+
+    Ptr<WifiMac> mac = DynamicCast<WifiNetDevice> (apDevice)->GetMac ();
+    for (AcIndex ac : {AC_BE, AC_BK, AC_VI, AC_VO})
+    {
+        mac->GetQosTxop (ac)->GetWifiMacQueue ()->SetMaxSize (QueueSize (size));
+    }
+}
+
+// q-quantile of a histogram, taken at the end of the bin that crosses it
+inline double HistogramQuantile (Histogram histogram, double q)
+{
+    uint64_t total = 0;
+    for (uint32_t i = 0; i < histogram.GetNBins (); ++i)
+    {
+        total += histogram.GetBinCount (i);
+    }
+    if (total == 0)
+    {
+        return 0.0;
+    }
+
+    uint64_t seen = 0;
+    for (uint32_t i = 0; i < histogram.GetNBins (); ++i)
+    {
+        seen += histogram.GetBinCount (i);
+        if (seen >= q * total)
+        {
+            return histogram.GetBinEnd (i);
+        }
+    }
+    return histogram.GetBinEnd (histogram.GetNBins () - 1);
+}
+
+// Sojourn-time histogram for every queue disc on the AP device (one per access
+// category under mq, or the root itself)
+class SojournTelemetry
+{
+public:
+    void Attach (Ptr<NetDevice> apDevice, double binWidthMs = 1.0)
+    {
+        Ptr<TrafficControlLayer> tc = apDevice->GetNode ()->GetObject<TrafficControlLayer> ();
+        Ptr<QueueDisc> root = tc->GetRootQueueDiscOnDevice (apDevice);
+        if (!root)
+        {
+            return;
+        }
+
+        if (DynamicCast<MqQueueDisc> (root))
+        {
+            m_queues.resize (root->GetNQueueDiscClasses ());
+            for (std::size_t i = 0; i < m_queues.size (); ++i)
+            {
+                Connect (m_queues[i], root->GetQueueDiscClass (i)->GetQueueDisc (), binWidthMs);
+            }
+        }
+        else
+        {
+            m_queues.resize (1);
+            Connect (m_queues[0], root, binWidthMs);
+        }
+    }
+
+    void Report (std::ostream &os) const
+    {
+        for (std::size_t i = 0; i < m_queues.size (); ++i)
+        {
+            const QueueSample &queue = m_queues[i];
+            const QueueDisc::Stats &stats = queue.disc->GetStats ();
+            double mean = queue.samples ? queue.sumMs / queue.samples : 0.0;
+
+            os << "Queue " << i << " (" << queue.disc->GetInstanceTypeId ().GetName () << ")"
+               << " dequeued " << queue.samples
+               << " dropped " << stats.nTotalDroppedPackets
+               << " sojourn mean " << mean << " ms"
+               << " p50 " << HistogramQuantile (queue.histogram, 0.50) << " ms"
+               << " p95 " << HistogramQuantile (queue.histogram, 0.95) << " ms"
+               << " p99 " << HistogramQuantile (queue.histogram, 0.99) << " ms"
+               << " max " << queue.maxMs << " ms" << std::endl;
+        }
+    }
+
+    // Queue index, bin start (ms), bin end (ms) and count, one line per non-empty bin
+    void WriteHistograms (const std::string &fileName) const
+    {
+        std::ofstream out (fileName);
+        out << "# queue\tbinStartMs\tbinEndMs\tcount" << std::endl;
+        for (std::size_t i = 0; i < m_queues.size (); ++i)
+        {
+            Histogram histogram = m_queues[i].histogram;
+            for (uint32_t b = 0; b < histogram.GetNBins (); ++b)
+            {
+                if (histogram.GetBinCount (b) > 0)
+                {
+                    out << i << "\t" << histogram.GetBinStart (b) << "\t" << histogram.GetBinEnd (b)
+                        << "\t" << histogram.GetBinCount (b) << std::endl;
+                }
+            }
+        }
+    }
+
+private:
+    struct QueueSample
+    {
+        Ptr<QueueDisc> disc;
+        Histogram histogram;
+        uint64_t samples = 0;
+        double sumMs = 0.0;
+        double maxMs = 0.0;
+    };
+
+    // The vector is sized before connecting, so the bound pointers stay valid
+    static void Connect (QueueSample &queue, Ptr<QueueDisc> disc, double binWidthMs)
+    {
+        queue.disc = disc;
+        queue.histogram.SetDefaultBinWidth (binWidthMs);
+        disc->TraceConnectWithoutContext ("SojournTime", MakeBoundCallback (&SojournTime, &queue));
+    }
+
+    static void SojournTime (QueueSample *queue, Time sojourn)
+    {
+        double ms = sojourn.GetSeconds () * 1000.0;
+        queue->histogram.AddValue (ms);
+        queue->samples++;
+        queue->sumMs += ms;
+        queue->maxMs = std::max (queue->maxMs, ms);
+    }
+
+    std::vector<QueueSample> m_queues;
+};
+
+// One-way delay of the UDP uploads, per client, from a FlowMonitor installed on all nodes
+inline void ReportUploadLatency (Ptr<FlowMonitor> monitor, Ptr<Ipv4FlowClassifier> classifier,
+                                 const Ipv4InterfaceContainer &clientInterfaces,
+                                 uint16_t uploadPort, std::ostream &os)
+{
+    monitor->CheckForLostPackets ();
+
+    for (const auto &flow : monitor->GetFlowStats ())
+    {
+        Ipv4FlowClassifier::FiveTuple tuple = classifier->FindFlow (flow.first);
+        if (tuple.protocol != 17 || tuple.destinationPort != uploadPort)
+        {
+            continue;
+        }
+
+        uint32_t clientId = 0;
+        while (clientId < clientInterfaces.GetN ()
+               && clientInterfaces.GetAddress (clientId) != tuple.sourceAddress)
+        {
+            ++clientId;
+        }
+
+        const FlowMonitor::FlowStats &stats = flow.second;
+        double meanMs = stats.rxPackets ? stats.delaySum.GetSeconds () * 1000.0 / stats.rxPackets : 0.0;
+        double jitterMs = stats.rxPackets > 1
+                              ? stats.jitterSum.GetSeconds () * 1000.0 / (stats.rxPackets - 1)
+                              : 0.0;
+
+        os << "Client " << clientId << " upload latency mean " << meanMs << " ms"
+           << " p95 " << HistogramQuantile (stats.delayHistogram, 0.95) * 1000.0 << " ms"
+           << " jitter " << jitterMs << " ms"
+           << " lost " << stats.lostPackets << "/" << stats.txPackets << std::endl;
+    }
+}
+
+#endif // QUEUE_TELEMETRY_H
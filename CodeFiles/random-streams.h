@@ -0,0 +1,99 @@
+#ifndef RANDOM_STREAMS_H
+#define RANDOM_STREAMS_H
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/wifi-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/applications-module.h"
+
+#include <map>
+
+using namespace ns3;
+
+// Fixed stream indices per subsystem and per node, so two variants of a
+// scenario run with the same RngRun draw the same fading, backoff, rate
+// sampling and start jitter for the same node (common random numbers).
+// Automatic stream assignment hands out streams in creation order instead, so
+// any change in what a variant creates shifts every stream after it.
+//
+// Each subsystem owns a block of 2^40 streams, each node 64 within it. Any
+// 32-bit node id fits (2^32 * 64 = 2^38), so blocks never overlap however
+// many nodes a layout has.
+enum class RandomSubsystem : int64_t
+{
+    Fading = 0,      // propagation loss chain of the channel (node 0 of the block)
+    Phy = 1,         // PHY interference/error models
+    Backoff = 2,     // DCF/EDCA backoff of every Txop
+    RateControl = 3, // Minstrel sampling
+    AppJitter = 4,   // application start jitter
+    Apps = 5,        // application random variables (OnOff on/off times)
+    Stack = 6,       // internet stack (ARP, ...)
+    Placement = 7,   // random client layouts (node 0 of the block)
+    Mobility = 8,    // client movement (waypoints, speeds, Gauss-Markov)
+};
+
+inline int64_t StreamIndex (RandomSubsystem subsystem, uint32_t nodeId)
+{
+    return (static_cast<int64_t> (subsystem) << 40) + static_cast<int64_t> (nodeId) * 64;
+}
+
+inline void AssignChannelStreams (Ptr<YansWifiChannel> channel)
+{
+    channel->AssignStreams (StreamIndex (RandomSubsystem::Fading, 0));
+}
+
+// PHY, backoff and rate control of every Wi-Fi device, keyed by its node
+inline void AssignWifiStreams (const NetDeviceContainer &devices)
+{
+    for (uint32_t i = 0; i < devices.GetN (); ++i)
+    {
+        Ptr<WifiNetDevice> device = DynamicCast<WifiNetDevice> (devices.Get (i));
+        uint32_t nodeId = device->GetNode ()->GetId ();
+        device->GetPhy ()->AssignStreams (StreamIndex (RandomSubsystem::Phy, nodeId));
+        device->GetMac ()->AssignStreams (StreamIndex (RandomSubsystem::Backoff, nodeId));
+        device->GetRemoteStationManager ()->AssignStreams (StreamIndex (RandomSubsystem::RateControl, nodeId));
+    }
+}
+
+inline void AssignStackStreams (const NodeContainer &nodes)
+{
+    InternetStackHelper stack;
+    for (uint32_t i = 0; i < nodes.GetN (); ++i)
+    {
+        stack.AssignStreams (NodeContainer (nodes.Get (i)), StreamIndex (RandomSubsystem::Stack, nodes.Get (i)->GetId ()));
+    }
+}
+
+// Applications of one node share its block, in container order, so pass every
+// application in one container
+inline void AssignApplicationStreams (const ApplicationContainer &apps)
+{
+    std::map<uint32_t, int64_t> next;
+    for (uint32_t i = 0; i < apps.GetN (); ++i)
+    {
+        uint32_t nodeId = apps.Get (i)->GetNode ()->GetId ();
+        if (next.find (nodeId) == next.end ())
+        {
+            next[nodeId] = StreamIndex (RandomSubsystem::Apps, nodeId);
+        }
+        next[nodeId] += apps.Get (i)->AssignStreams (next[nodeId]);
+    }
+}
+
+// Uniform start jitter in [0, maxJitter) drawn from the node's own stream
+inline Time StartJitter (uint32_t nodeId, Time maxJitter, bool fixedStreams)
+{
+    if (!maxJitter.IsStrictlyPositive ())
+    {
+        return Time (0);
+    }
+    Ptr<UniformRandomVariable> jitter = CreateObject<UniformRandomVariable> ();
+    if (fixedStreams)
+    {
+        jitter->SetStream (StreamIndex (RandomSubsystem::AppJitter, nodeId));
+    }
+    return NanoSeconds (static_cast<int64_t> (jitter->GetValue (0.0, maxJitter.GetNanoSeconds ())));
+}
+
+#endif // RANDOM_STREAMS_H
@@ -0,0 +1,256 @@
+#ifndef RATE_TELEMETRY_H
+#define RATE_TELEMETRY_H
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/wifi-module.h"
+
+#include "bulk-trace.h"
+#include "streaming-stats.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <fstream>
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+
+using namespace ns3;
+
+// What the rate manager did for each client, seen from the data frames it
+// made the PHYs send: the AP's decisions towards the client (down) and the
+// client's towards the AP (up). MinstrelHtWifiManager keeps its state
+// private, so the rest is inferred per update interval (the manager's
+// UpdateStatistics attribute): the MCS carrying most first attempts in an
+// interval is taken as that interval's best rate, first attempts at any
+// other MCS as sampling, and retries are counted apart since they follow the
+// retry chain. Intervals are closed lazily by the next frame, so nothing is
+// scheduled, and every counter lives in arrays allocated at Attach; a frame
+// costs a few increments. Intervals without first attempts are not counted.
+class RateTelemetry
+{
+public:
+    // Slots 0..31 are HT MCS (VHT/HE MCS fit too), the last one is non-HT
+    static constexpr std::size_t kSlots = RateCounters::kSlots;
+
+    void Attach (Ptr<NetDevice> apDevice, const NetDeviceContainer &staDevices)
+    {
+        Ptr<WifiNetDevice> ap = DynamicCast<WifiNetDevice> (apDevice);
+        TimeValue interval;
+        if (ap->GetRemoteStationManager ()->GetAttributeFailSafe ("UpdateStatistics", interval))
+        {
+            m_intervalNs = interval.Get ().GetNanoSeconds ();
+        }
+        m_apAddress = ap->GetMac ()->GetAddress ();
+        m_band = ap->GetPhy ()->GetPhyBand ();
+        m_clients.resize (staDevices.GetN ());
+
+        for (uint32_t i = 0; i < staDevices.GetN (); ++i)
+        {
+            m_byMac[Mac48Address::ConvertFrom (staDevices.Get (i)->GetAddress ())] = i;
+        }
+        BulkTraceConnect (staDevices, "PhyTxPsduBegin", MakeBoundCallback (&RateTelemetry::UplinkTx, this),
+                          [] (Ptr<NetDevice> device) { return DynamicCast<WifiNetDevice> (device)->GetPhy (); });
+        ap->GetPhy ()->TraceConnectWithoutContext ("PhyTxPsduBegin", MakeCallback (&RateTelemetry::DownlinkTx, this));
+    }
+
+    // Closes the open intervals; call after Run ()
+    void Finish ()
+    {
+        int64_t now = Simulator::Now ().GetNanoSeconds ();
+        for (Client &client : m_clients)
+        {
+            for (Direction &direction : client.directions)
+            {
+                CloseWindow (direction, now);
+            }
+        }
+    }
+
+    void Report (std::ostream &os) const
+    {
+        static const char *names[] = {"down", "up"};
+        for (std::size_t i = 0; i < m_clients.size (); ++i)
+        {
+            for (std::size_t d = 0; d < 2; ++d)
+            {
+                const Direction &direction = m_clients[i].directions[d];
+                uint64_t first = direction.normal + direction.sampling;
+                if (first == 0)
+                {
+                    continue;
+                }
+                std::size_t top = std::max_element (direction.bestIntervals.begin (), direction.bestIntervals.end ()) -
+                                  direction.bestIntervals.begin ();
+                os << "Client " << i << " rate " << names[d]
+                   << " frames " << first
+                   << " sampling " << 100.0 * direction.sampling / first << " %"
+                   << " retries " << 100.0 * direction.retries / (first + direction.retries) << " %"
+                   << " changes/interval " << (direction.intervals ? double (direction.changes) / direction.intervals : 0.0)
+                   << " top " << RateCounters::SlotName (top)
+                   << " residency " << (direction.intervals ? 100.0 * direction.bestIntervals[top] / direction.intervals : 0.0)
+                   << " %" << std::endl;
+            }
+        }
+    }
+
+    // Adds every client's counters to the summary's, per direction, so they
+    // are saved and merged with --summaryFile like the completion times
+    void AddTo (CompletionSummary &summary) const
+    {
+        for (const Client &client : m_clients)
+        {
+            for (std::size_t d = 0; d < 2; ++d)
+            {
+                const Direction &direction = client.directions[d];
+                RateCounters &rates = summary.GetRates (d);
+                for (std::size_t slot = 0; slot < kSlots; ++slot)
+                {
+                    rates.frames[slot] += direction.frames[slot];
+                    rates.airtimeNs[slot] += direction.airtimeNs[slot];
+                    rates.bestIntervals[slot] += direction.bestIntervals[slot];
+                }
+                rates.normal += direction.normal;
+                rates.sampling += direction.sampling;
+                rates.retries += direction.retries;
+                rates.intervals += direction.intervals;
+                rates.changes += direction.changes;
+            }
+        }
+    }
+
+    // Client, direction, MCS, first attempts, airtime (s, retries included) and
+    // time as the interval's best rate (s), one line per MCS used
+    void Write (const std::string &fileName) const
+    {
+        static const char *names[] = {"down", "up"};
+        std::ofstream out (fileName);
+        out << "# client\tdirection\tmcs\tframes\tairtimeS\tbestS" << std::endl;
+        for (std::size_t i = 0; i < m_clients.size (); ++i)
+        {
+            for (std::size_t d = 0; d < 2; ++d)
+            {
+                const Direction &direction = m_clients[i].directions[d];
+                for (std::size_t slot = 0; slot < kSlots; ++slot)
+                {
+                    if (direction.frames[slot] == 0 && direction.airtimeNs[slot] == 0 && direction.bestIntervals[slot] == 0)
+                    {
+                        continue;
+                    }
+                    out << i << "\t" << names[d] << "\t" << RateCounters::SlotName (slot) << "\t" << direction.frames[slot]
+                        << "\t" << direction.airtimeNs[slot] * 1e-9
+                        << "\t" << direction.bestIntervals[slot] * m_intervalNs * 1e-9 << std::endl;
+                }
+            }
+        }
+    }
+
+private:
+    struct Direction
+    {
+        std::array<uint64_t, kSlots> frames {};   // first attempts
+        std::array<int64_t, kSlots> airtimeNs {};
+        std::array<uint32_t, kSlots> window {};   // first attempts in the open interval
+        std::array<uint32_t, kSlots> bestIntervals {};
+        uint64_t normal = 0;
+        uint64_t sampling = 0;
+        uint64_t retries = 0;
+        uint64_t intervals = 0;
+        uint64_t changes = 0;
+        int best = -1;
+        int64_t windowEndNs = 0;
+    };
+
+    struct Client
+    {
+        Direction directions[2]; // down, up
+    };
+
+    static std::size_t Slot (const WifiTxVector &txVector)
+    {
+        WifiMode mode = txVector.GetMode ();
+        return mode.GetModulationClass () >= WIFI_MOD_CLASS_HT ? std::min<std::size_t> (mode.GetMcsValue (), kSlots - 2)
+                                                                : kSlots - 1;
+    }
+
+    void DownlinkTx (WifiConstPsduMap psduMap, WifiTxVector txVector, double txPowerW)
+    {
+        for (const auto &entry : psduMap)
+        {
+            auto it = m_byMac.find (entry.second->GetAddr1 ());
+            if (it != m_byMac.end ())
+            {
+                Count (m_clients[it->second].directions[0], entry.second, txVector, psduMap);
+            }
+        }
+    }
+
+    static void UplinkTx (RateTelemetry *telemetry, uint32_t client, WifiConstPsduMap psduMap, WifiTxVector txVector,
+                          double txPowerW)
+    {
+        for (const auto &entry : psduMap)
+        {
+            if (entry.second->GetAddr1 () == telemetry->m_apAddress)
+            {
+                telemetry->Count (telemetry->m_clients[client].directions[1], entry.second, txVector, psduMap);
+            }
+        }
+    }
+
+    void Count (Direction &direction, Ptr<const WifiPsdu> psdu, const WifiTxVector &txVector,
+                const WifiConstPsduMap &psduMap)
+    {
+        if (!psdu->GetHeader (0).IsData ())
+        {
+            return;
+        }
+        int64_t now = Simulator::Now ().GetNanoSeconds ();
+        if (now >= direction.windowEndNs)
+        {
+            CloseWindow (direction, now);
+        }
+
+        std::size_t slot = Slot (txVector);
+        direction.airtimeNs[slot] += WifiPhy::CalculateTxDuration (psduMap, txVector, m_band).GetNanoSeconds ();
+        if (psdu->GetHeader (0).IsRetry ())
+        {
+            direction.retries++;
+            return;
+        }
+        direction.frames[slot]++;
+        direction.window[slot]++;
+    }
+
+    // Classifies the interval's first attempts and opens the interval containing now
+    void CloseWindow (Direction &direction, int64_t now)
+    {
+        auto top = std::max_element (direction.window.begin (), direction.window.end ());
+        if (*top > 0)
+        {
+            int best = top - direction.window.begin ();
+            uint64_t total = 0;
+            for (uint32_t count : direction.window)
+            {
+                total += count;
+            }
+            direction.normal += *top;
+            direction.sampling += total - *top;
+            direction.changes += direction.best >= 0 && best != direction.best;
+            direction.best = best;
+            direction.bestIntervals[best]++;
+            direction.intervals++;
+            direction.window.fill (0);
+        }
+        direction.windowEndNs = now - now % m_intervalNs + m_intervalNs;
+    }
+
+    int64_t m_intervalNs = 100000000; // managers without UpdateStatistics
+    Mac48Address m_apAddress;
+    WifiPhyBand m_band = WIFI_PHY_BAND_UNSPECIFIED;
+    std::vector<Client> m_clients;
+    std::map<Mac48Address, uint32_t> m_byMac;
+};
+
+#endif // RATE_TELEMETRY_H
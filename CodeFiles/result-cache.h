@@ -0,0 +1,450 @@
+#ifndef RESULT_CACHE_H
+#define RESULT_CACHE_H
+
+#include "ns3/core-module.h"
+
+#include <elf.h>
+#include <link.h>
+#include <sys/stat.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <streambuf>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+using namespace ns3;
+
+// CommandLine that remembers every value it was given, so the resolved
+// configuration (defaults included) can be hashed after Parse (), and that
+// can check a value against an option's type before parsing it.
+class RecordingCommandLine : public CommandLine
+{
+public:
+    using CommandLine::AddValue;
+
+    template <typename T>
+    void AddValue (const std::string &name, const std::string &help, T &value)
+    {
+        CommandLine::AddValue (name, help, value);
+        Value recorded;
+        recorded.name = name;
+        recorded.print = [&value] () {
+            std::ostringstream os;
+            os << value;
+            return os.str ();
+        };
+        recorded.check = [] (const std::string &text) {
+            if constexpr (std::is_same<T, std::string>::value)
+            {
+                return true;
+            }
+            else if constexpr (std::is_same<T, bool>::value)
+            {
+                return text == "true" || text == "false" || text == "t" || text == "f" || text == "1" || text == "0";
+            }
+            else
+            {
+                // Streams wrap negative input into unsigned types
+                if (std::is_unsigned<T>::value && text.find ('-') != std::string::npos)
+                {
+                    return false;
+                }
+                T parsed;
+                std::istringstream is (text);
+                is >> parsed;
+                return !is.fail () && (is >> std::ws).eof ();
+            }
+        };
+        m_values.push_back (recorded);
+    }
+
+    std::string GetResolvedValues () const
+    {
+        std::ostringstream os;
+        for (const auto &value : m_values)
+        {
+            os << value.name << "=" << value.print () << "\n";
+        }
+        return os.str ();
+    }
+
+    bool HasValue (const std::string &name) const
+    {
+        return Find (name) != nullptr;
+    }
+
+    // Whether text parses as the type of option name
+    bool IsValid (const std::string &name, const std::string &text) const
+    {
+        const Value *value = Find (name);
+        return value && value->check (text);
+    }
+
+private:
+    struct Value
+    {
+        std::string name;
+        std::function<std::string ()> print;
+        std::function<bool (const std::string &)> check;
+    };
+
+    const Value *Find (const std::string &name) const
+    {
+        for (const auto &value : m_values)
+        {
+            if (value.name == name)
+            {
+                return &value;
+            }
+        }
+        return nullptr;
+    }
+
+    std::vector<Value> m_values;
+};
+
+// Copies everything written to a stream into a string as well
+class TeeBuffer : public std::streambuf
+{
+public:
+    TeeBuffer (std::streambuf *sink)
+        : m_sink (sink)
+    {
+    }
+
+    std::string GetCaptured () const
+    {
+        return m_captured.str ();
+    }
+
+protected:
+    int overflow (int c) override
+    {
+        if (c != EOF)
+        {
+            m_captured.put (static_cast<char> (c));
+            return m_sink->sputc (static_cast<char> (c));
+        }
+        return c;
+    }
+
+    std::streamsize xsputn (const char *s, std::streamsize n) override
+    {
+        m_captured.write (s, n);
+        return m_sink->sputn (s, n);
+    }
+
+    int sync () override
+    {
+        return m_sink->pubsync ();
+    }
+
+private:
+    std::streambuf *m_sink;
+    std::ostringstream m_captured;
+};
+
+// Result cache keyed by a hash of the fully resolved configuration: the
+// scenario's command-line values, every attribute default (which is where
+// Config::SetDefault and --ns3::... overrides end up), the global values
+// (RngSeed, RngRun, ...) and the build ids of the binary and the ns-3
+// libraries it loaded. An entry holds the run's stdout and copies of its
+// output files; a hit replays both instead of simulating.
+class ResultCache
+{
+public:
+    // Registered on the plain CommandLine, so they stay out of the key
+    void AddOptions (CommandLine &cmd)
+    {
+        cmd.AddValue ("cacheDir", "Directory of the result cache (empty to disable)", m_cacheDir);
+        cmd.AddValue ("forceRerun", "Simulate even on a cache hit, and refresh the cached entry", m_forceRerun);
+    }
+
+    bool IsEnabled () const
+    {
+        return !m_cacheDir.empty ();
+    }
+
+    // Call after Parse () and after the scenario's own Config::SetDefault calls
+    void SetKey (const std::string &program, const RecordingCommandLine &cmd)
+    {
+        std::ostringstream os;
+        os << "program=" << std::filesystem::path (program).filename ().string () << "\n"
+           << "[values]\n" << cmd.GetResolvedValues ()
+           << "[globals]\n" << DescribeGlobalValues ()
+           << "[defaults]\n" << DescribeAttributeDefaults ()
+           << "[build]\n" << DescribeBuild ();
+        m_config = os.str ();
+
+        std::ostringstream hash;
+        hash << std::hex << std::setw (16) << std::setfill ('0') << Fnv1a (m_config);
+        m_key = hash.str ();
+    }
+
+    std::string GetKey () const
+    {
+        return m_key;
+    }
+
+    // Output files produced by the run, restored on a hit
+    void AddOutputFile (const std::string &path)
+    {
+        if (!path.empty ())
+        {
+            m_outputFiles.push_back (path);
+        }
+    }
+
+    // Path of an extra artifact kept in the entry (e.g. the run's own summary)
+    std::string GetEntryFile (const std::string &name) const
+    {
+        return (EntryDir () / name).string ();
+    }
+
+    // True if a stored entry matches; replays its stdout and output files
+    bool Replay (std::ostream &os)
+    {
+        if (!IsEnabled () || m_forceRerun)
+        {
+            return false;
+        }
+
+        std::filesystem::path entry = EntryDir ();
+        if (ReadFile (entry / "config.txt") != m_config)
+        {
+            return false; // missing, or a hash collision
+        }
+
+        os << ReadFile (entry / "stdout.txt");
+        std::ifstream manifest (entry / "files.txt");
+        std::string line;
+        for (std::size_t i = 0; std::getline (manifest, line); ++i)
+        {
+            std::filesystem::copy_file (entry / ("file" + std::to_string (i)), line,
+                                        std::filesystem::copy_options::overwrite_existing);
+        }
+        std::cerr << "Result cache hit " << m_key << std::endl;
+        return true;
+    }
+
+    // Starts capturing std::cout for the entry; extra artifacts written to
+    // GetEntryFile () before Store () are kept with it
+    void BeginCapture ()
+    {
+        if (!IsEnabled ())
+        {
+            return;
+        }
+        std::filesystem::remove_all (EntryDir ());
+        std::filesystem::create_directories (EntryDir ());
+        m_tee.reset (new TeeBuffer (std::cout.rdbuf ()));
+        m_savedBuffer = std::cout.rdbuf (m_tee.get ());
+    }
+
+    void Store ()
+    {
+        if (!m_tee)
+        {
+            return;
+        }
+        std::cout.flush ();
+        std::cout.rdbuf (m_savedBuffer);
+
+        std::filesystem::path entry = EntryDir ();
+        std::ofstream (entry / "stdout.txt") << m_tee->GetCaptured ();
+        std::ofstream manifest (entry / "files.txt");
+        std::size_t stored = 0;
+        for (const auto &file : m_outputFiles)
+        {
+            if (std::filesystem::exists (file))
+            {
+                std::filesystem::copy_file (file, entry / ("file" + std::to_string (stored++)),
+                                            std::filesystem::copy_options::overwrite_existing);
+                manifest << file << "\n";
+            }
+        }
+        // Written last: an entry without config.txt never matches
+        std::ofstream (entry / "config.txt") << m_config;
+        m_tee.reset ();
+    }
+
+private:
+    std::filesystem::path EntryDir () const
+    {
+        return std::filesystem::path (m_cacheDir) / m_key;
+    }
+
+    static std::string ReadFile (const std::filesystem::path &path)
+    {
+        std::ifstream in (path);
+        std::ostringstream os;
+        os << in.rdbuf ();
+        return os.str ();
+    }
+
+    static uint64_t Fnv1a (const std::string &data)
+    {
+        uint64_t hash = 14695981039346656037ULL;
+        for (unsigned char c : data)
+        {
+            hash ^= c;
+            hash *= 1099511628211ULL;
+        }
+        return hash;
+    }
+
+    static std::string DescribeGlobalValues ()
+    {
+        std::ostringstream os;
+        for (auto it = GlobalValue::Begin (); it != GlobalValue::End (); ++it)
+        {
+            StringValue value;
+            (*it)->GetValue (value);
+            os << (*it)->GetName () << "=" << value.Get () << "\n";
+        }
+        return os.str ();
+    }
+
+    // Pointer-valued defaults serialize as an address, so describe the object
+    // they point to (type and plain attributes) instead
+    static std::string DescribeValue (Ptr<const AttributeValue> value, Ptr<const AttributeChecker> checker)
+    {
+        const PointerValue *pointer = dynamic_cast<const PointerValue *> (PeekPointer (value));
+        if (!pointer)
+        {
+            return value->SerializeToString (checker);
+        }
+
+        Ptr<Object> object = pointer->GetObject ();
+        if (!object)
+        {
+            return "null";
+        }
+
+        std::ostringstream os;
+        os << object->GetInstanceTypeId ().GetName () << "[";
+        for (TypeId tid = object->GetInstanceTypeId (); tid != Object::GetTypeId (); tid = tid.GetParent ())
+        {
+            for (std::size_t i = 0; i < tid.GetAttributeN (); ++i)
+            {
+                TypeId::AttributeInformation info = tid.GetAttribute (i);
+                if (dynamic_cast<const PointerValue *> (PeekPointer (info.initialValue)))
+                {
+                    continue;
+                }
+                StringValue attribute;
+                if (object->GetAttributeFailSafe (info.name, attribute))
+                {
+                    os << info.name << "=" << attribute.Get () << "|";
+                }
+            }
+        }
+        os << "]";
+        return os.str ();
+    }
+
+    static std::string DescribeAttributeDefaults ()
+    {
+        std::ostringstream os;
+        for (uint16_t t = 0; t < TypeId::GetRegisteredN (); ++t)
+        {
+            TypeId tid = TypeId::GetRegistered (t);
+            for (std::size_t i = 0; i < tid.GetAttributeN (); ++i)
+            {
+                TypeId::AttributeInformation info = tid.GetAttribute (i);
+                if (info.checker->GetValueTypeName () == "ns3::ObjectPtrContainerValue")
+                {
+                    continue; // runtime containers, no meaningful default
+                }
+                os << tid.GetName () << "::" << info.name << "="
+                   << DescribeValue (info.initialValue, info.checker) << "\n";
+            }
+        }
+        return os.str ();
+    }
+
+    // GNU build-id of the executable and every ns-3 library; size and mtime
+    // when the linker did not emit one
+    static std::string DescribeBuild ()
+    {
+        std::vector<std::string> ids;
+        dl_iterate_phdr (
+            [] (struct dl_phdr_info *info, size_t, void *data) {
+                std::string name = info->dlpi_name ? info->dlpi_name : "";
+                if (!name.empty () && name.find ("ns3") == std::string::npos)
+                {
+                    return 0;
+                }
+
+                std::ostringstream os;
+                os << (name.empty () ? "exe" : std::filesystem::path (name).filename ().string ()) << "=";
+                bool found = false;
+                for (int i = 0; i < info->dlpi_phnum && !found; ++i)
+                {
+                    const ElfW (Phdr) &phdr = info->dlpi_phdr[i];
+                    if (phdr.p_type != PT_NOTE)
+                    {
+                        continue;
+                    }
+                    const char *p = reinterpret_cast<const char *> (info->dlpi_addr + phdr.p_vaddr);
+                    const char *end = p + phdr.p_memsz;
+                    while (p + sizeof (ElfW (Nhdr)) <= end)
+                    {
+                        const ElfW (Nhdr) *note = reinterpret_cast<const ElfW (Nhdr) *> (p);
+                        const char *desc = p + sizeof (ElfW (Nhdr)) + ((note->n_namesz + 3) & ~3u);
+                        if (note->n_type == NT_GNU_BUILD_ID)
+                        {
+                            for (uint32_t b = 0; b < note->n_descsz; ++b)
+                            {
+                                os << std::hex << std::setw (2) << std::setfill ('0')
+                                   << static_cast<int> (static_cast<unsigned char> (desc[b]));
+                            }
+                            found = true;
+                            break;
+                        }
+                        p = desc + ((note->n_descsz + 3) & ~3u);
+                    }
+                }
+
+                if (!found)
+                {
+                    struct stat st;
+                    std::string path = name.empty () ? "/proc/self/exe" : name;
+                    if (stat (path.c_str (), &st) == 0)
+                    {
+                        os << "size" << st.st_size << "-mtime" << st.st_mtime;
+                    }
+                }
+                static_cast<std::vector<std::string> *> (data)->push_back (os.str ());
+                return 0;
+            },
+            &ids);
+
+        std::sort (ids.begin (), ids.end ());
+        std::ostringstream os;
+        for (const auto &id : ids)
+        {
+            os << id << "\n";
+        }
+        return os.str ();
+    }
+
+    std::string m_cacheDir;
+    bool m_forceRerun = false;
+    std::string m_config;
+    std::string m_key;
+    std::vector<std::string> m_outputFiles;
+    std::unique_ptr<TeeBuffer> m_tee;
+    std::streambuf *m_savedBuffer = nullptr;
+};
+
+#endif // RESULT_CACHE_H
@@ -0,0 +1,335 @@
+#ifndef SAMPLED_ANIM_H
+#define SAMPLED_ANIM_H
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/mobility-module.h"
+#include "ns3/wifi-module.h"
+#include "ns3/point-to-point-module.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using namespace ns3;
+
+// NetAnim output for runs too large for AnimationInterface. Instead of one
+// XML element per packet, frames received over each link (Wi-Fi
+// transmitter/receiver pair or point-to-point channel) are counted per time
+// window, and at the end of a window every active link gets one linkupdate
+// with its packet count and rate. Only one packet in every sampleEvery per
+// link is drawn as a packet animation. Windows are closed lazily by the next
+// packet, so no events are added to the simulation, and elements go straight
+// to the file; memory is one counter per link. Moving nodes get a position
+// update at each course change and, between course changes, at every window
+// a packet closes.
+class SampledAnimation
+{
+public:
+    SampledAnimation (const std::string &fileName, Time window, uint32_t sampleEvery)
+        : m_window (window),
+          m_sampleEvery (std::max<uint32_t> (sampleEvery, 1)),
+          m_file (std::fopen (fileName.c_str (), "w"))
+    {
+        if (!m_file)
+        {
+            NS_FATAL_ERROR ("Cannot open animation file " << fileName);
+        }
+        if (!window.IsStrictlyPositive ())
+        {
+            NS_FATAL_ERROR ("The animation window must be positive");
+        }
+        std::setvbuf (m_file, nullptr, _IOFBF, 1 << 20);
+        m_windowEnd = window;
+    }
+
+    ~SampledAnimation ()
+    {
+        Close ();
+    }
+
+    void SetDescription (Ptr<Node> node, const std::string &description, uint8_t r, uint8_t g, uint8_t b)
+    {
+        m_descriptions.push_back ({node->GetId (), description, r, g, b});
+    }
+
+    // Wi-Fi frames between any two of the attached devices, drawn against
+    // links declared from each station to the first AP device
+    void AttachWifi (const NetDeviceContainer &apDevices, const NetDeviceContainer &staDevices)
+    {
+        for (const NetDeviceContainer *devices : {&apDevices, &staDevices})
+        {
+            for (uint32_t i = 0; i < devices->GetN (); ++i)
+            {
+                Ptr<WifiNetDevice> device = DynamicCast<WifiNetDevice> (devices->Get (i));
+                m_wifiNodes[device->GetMac ()->GetAddress ()] = device->GetNode ()->GetId ();
+                device->GetPhy ()->TraceConnectWithoutContext (
+                    "MonitorSnifferRx", MakeBoundCallback (&SampledAnimation::WifiRx, this, device));
+            }
+        }
+        if (apDevices.GetN () > 0)
+        {
+            uint32_t ap = apDevices.Get (0)->GetNode ()->GetId ();
+            for (uint32_t i = 0; i < staDevices.GetN (); ++i)
+            {
+                m_declaredLinks.push_back ({staDevices.Get (i)->GetNode ()->GetId (), ap});
+            }
+        }
+    }
+
+    void AttachPointToPoint (const NetDeviceContainer &devices)
+    {
+        for (uint32_t i = 0; i < devices.GetN (); ++i)
+        {
+            Ptr<PointToPointNetDevice> device = DynamicCast<PointToPointNetDevice> (devices.Get (i));
+            Ptr<PointToPointChannel> channel = DynamicCast<PointToPointChannel> (device->GetChannel ());
+            Ptr<PointToPointNetDevice> peer = channel->GetPointToPointDevice (channel->GetPointToPointDevice (0) == device ? 1 : 0);
+            if (i % 2 == 0)
+            {
+                m_declaredLinks.push_back ({device->GetNode ()->GetId (), peer->GetNode ()->GetId ()});
+            }
+            device->TraceConnectWithoutContext ("PhyRxEnd", MakeBoundCallback (&SampledAnimation::PointToPointRx, this, device, peer));
+        }
+    }
+
+    // Writes the nodes at their current positions, their descriptions and the
+    // declared links; call once, after mobility is installed and before Run ()
+    void WriteTopology ()
+    {
+        std::fprintf (m_file, "<anim ver=\"netanim-3.108\" filetype=\"animation\" >\n");
+
+        std::vector<Vector> positions;
+        for (auto it = NodeList::Begin (); it != NodeList::End (); ++it)
+        {
+            Ptr<MobilityModel> mobility = (*it)->GetObject<MobilityModel> ();
+            Vector position = mobility ? mobility->GetPosition () : Vector ();
+            positions.push_back (position);
+            std::fprintf (m_file, "<node id=\"%u\" sysId=\"0\" locX=\"%.3f\" locY=\"%.3f\" />\n",
+                          (*it)->GetId (), position.x, position.y);
+            if (mobility)
+            {
+                if (mobility->GetVelocity ().GetLength () > 0)
+                {
+                    m_moving[(*it)->GetId ()] = mobility;
+                }
+                mobility->TraceConnectWithoutContext (
+                    "CourseChange", MakeBoundCallback (&SampledAnimation::CourseChange, this, (*it)->GetId ()));
+            }
+        }
+
+        // NetAnim draws nodes one unit wide, which buries a ring or line of a
+        // few hundred clients spaced well under a metre apart in one blob
+        double size = std::min (1.0, 0.8 * MinimumSpacing (positions));
+        for (uint32_t id = 0; id < positions.size (); ++id)
+        {
+            std::fprintf (m_file, "<nu p=\"s\" t=\"0\" id=\"%u\" w=\"%.3f\" h=\"%.3f\" />\n", id, size, size);
+        }
+        for (const Description &d : m_descriptions)
+        {
+            std::fprintf (m_file, "<nu p=\"d\" t=\"0\" id=\"%u\" descr=\"%s\" />\n", d.node, d.text.c_str ());
+            std::fprintf (m_file, "<nu p=\"c\" t=\"0\" id=\"%u\" r=\"%u\" g=\"%u\" b=\"%u\" />\n", d.node, d.r, d.g, d.b);
+        }
+        for (const auto &link : m_declaredLinks)
+        {
+            std::fprintf (m_file, "<link fromId=\"%u\" toId=\"%u\" fd=\"\" tld=\"\" ld=\"\" />\n", link.first, link.second);
+        }
+    }
+
+    void Close ()
+    {
+        if (!m_file)
+        {
+            return;
+        }
+        CloseWindows (Simulator::Now () + m_window);
+        std::fprintf (m_file, "</anim>\n");
+        std::fclose (m_file);
+        m_file = nullptr;
+    }
+
+    void Report (std::ostream &os) const
+    {
+        os << "Animation: " << m_packets << " packets on " << m_links.size () << " links, "
+           << m_sampled << " drawn, " << m_updates << " link updates, " << m_positions << " position updates"
+           << std::endl;
+    }
+
+private:
+    struct Description
+    {
+        uint32_t node;
+        std::string text;
+        uint8_t r, g, b;
+    };
+
+    struct Link
+    {
+        uint32_t from;
+        uint32_t to;
+        uint64_t total;   // packets over the whole run, drives the sampling
+        uint64_t packets; // in the current window
+        uint64_t bytes;
+        bool shown;       // has a non-empty description in NetAnim
+    };
+
+    static double MinimumSpacing (std::vector<Vector> positions)
+    {
+        std::sort (positions.begin (), positions.end (), [] (const Vector &a, const Vector &b) { return a.x < b.x; });
+        double best = 1.0;
+        for (std::size_t i = 0; i < positions.size (); ++i)
+        {
+            for (std::size_t j = i + 1; j < positions.size () && positions[j].x - positions[i].x < best; ++j)
+            {
+                double d = std::hypot (positions[j].x - positions[i].x, positions[j].y - positions[i].y);
+                if (d > 0 && d < best)
+                {
+                    best = d;
+                }
+            }
+        }
+        return best;
+    }
+
+    static void WifiRx (SampledAnimation *anim, Ptr<WifiNetDevice> device, Ptr<const Packet> packet,
+                        uint16_t channelFreqMhz, WifiTxVector txVector, MpduInfo aMpdu,
+                        SignalNoiseDbm signalNoise, uint16_t staId)
+    {
+        WifiMacHeader header;
+        packet->PeekHeader (header);
+        if (!header.IsData () || header.GetAddr1 () != device->GetMac ()->GetAddress ())
+        {
+            return;
+        }
+        auto it = anim->m_wifiNodes.find (header.GetAddr2 ());
+        if (it == anim->m_wifiNodes.end ())
+        {
+            return;
+        }
+        Time airtime = WifiPhy::CalculateTxDuration (packet->GetSize (), txVector, device->GetPhy ()->GetPhyBand ());
+        anim->Count (it->second, device->GetNode ()->GetId (), packet->GetSize (), airtime);
+    }
+
+    static void PointToPointRx (SampledAnimation *anim, Ptr<PointToPointNetDevice> device,
+                                Ptr<PointToPointNetDevice> peer, Ptr<const Packet> packet)
+    {
+        DataRateValue rate;
+        peer->GetAttribute ("DataRate", rate);
+        TimeValue delay;
+        device->GetChannel ()->GetAttribute ("Delay", delay);
+        Time duration = rate.Get ().CalculateBytesTxTime (packet->GetSize ()) + delay.Get ();
+        anim->Count (peer->GetNode ()->GetId (), device->GetNode ()->GetId (), packet->GetSize (), duration);
+    }
+
+    static void CourseChange (SampledAnimation *anim, uint32_t node, Ptr<const MobilityModel> mobility)
+    {
+        if (!anim->m_file)
+        {
+            return;
+        }
+        if (mobility->GetVelocity ().GetLength () > 0)
+        {
+            anim->m_moving[node] = ConstCast<MobilityModel> (mobility);
+        }
+        else
+        {
+            anim->m_moving.erase (node);
+        }
+        anim->WritePosition (node, mobility->GetPosition ());
+    }
+
+    void WritePosition (uint32_t node, const Vector &position)
+    {
+        std::fprintf (m_file, "<nu p=\"p\" t=\"%.6f\" id=\"%u\" x=\"%.3f\" y=\"%.3f\" />\n",
+                      Simulator::Now ().GetSeconds (), node, position.x, position.y);
+        m_positions++;
+    }
+
+    // A packet from -> to that has just been fully received after duration on air
+    void Count (uint32_t from, uint32_t to, uint32_t bytes, Time duration)
+    {
+        Time now = Simulator::Now ();
+        if (now >= m_windowEnd)
+        {
+            CloseWindows (now);
+            for (const auto &entry : m_moving)
+            {
+                WritePosition (entry.first, entry.second->GetPosition ());
+            }
+        }
+
+        Link &link = m_links.emplace (uint64_t (from) << 32 | to, Link {from, to, 0, 0, 0, false}).first->second;
+        if (link.total++ % m_sampleEvery == 0)
+        {
+            double rx = now.GetSeconds ();
+            double tx = (now - duration).GetSeconds ();
+            std::fprintf (m_file, "<p fId=\"%u\" fbTx=\"%.9f\" lbTx=\"%.9f\" tId=\"%u\" fbRx=\"%.9f\" lbRx=\"%.9f\" />\n",
+                          from, tx, tx, to, rx, rx);
+            m_sampled++;
+        }
+        link.packets++;
+        link.bytes += bytes;
+        m_packets++;
+    }
+
+    // Writes the windows ending at or before now and opens the one containing now
+    void CloseWindows (Time now)
+    {
+        while (now >= m_windowEnd)
+        {
+            bool anyShown = false;
+            for (auto &entry : m_links)
+            {
+                Link &link = entry.second;
+                if (link.packets > 0)
+                {
+                    double mbps = link.bytes * 8.0 / m_window.GetSeconds () / 1e6;
+                    std::fprintf (m_file, "<linkupdate t=\"%.6f\" fromId=\"%u\" toId=\"%u\" ld=\"%lu pkts %.2f Mbps\" />\n",
+                                  m_windowEnd.GetSeconds (), link.from, link.to,
+                                  static_cast<unsigned long> (link.packets), mbps);
+                    link.shown = true;
+                    m_updates++;
+                }
+                else if (link.shown)
+                {
+                    std::fprintf (m_file, "<linkupdate t=\"%.6f\" fromId=\"%u\" toId=\"%u\" ld=\"\" />\n",
+                                  m_windowEnd.GetSeconds (), link.from, link.to);
+                    link.shown = false;
+                    m_updates++;
+                }
+                anyShown = anyShown || link.shown;
+                link.packets = 0;
+                link.bytes = 0;
+            }
+            m_windowEnd += m_window;
+
+            // Idle gap: skip straight to the window containing now
+            if (!anyShown && now >= m_windowEnd)
+            {
+                int64_t skip = (now - m_windowEnd).GetNanoSeconds () / m_window.GetNanoSeconds () + 1;
+                m_windowEnd += NanoSeconds (skip * m_window.GetNanoSeconds ());
+            }
+        }
+    }
+
+    Time m_window;
+    uint32_t m_sampleEvery;
+    std::FILE *m_file;
+    Time m_windowEnd;
+    std::unordered_map<uint64_t, Link> m_links;
+    std::map<Mac48Address, uint32_t> m_wifiNodes;
+    std::vector<std::pair<uint32_t, uint32_t>> m_declaredLinks;
+    std::vector<Description> m_descriptions;
+    std::map<uint32_t, Ptr<MobilityModel>> m_moving;
+    uint64_t m_packets = 0;
+    uint64_t m_sampled = 0;
+    uint64_t m_updates = 0;
+    uint64_t m_positions = 0;
+};
+
+#endif // SAMPLED_ANIM_H
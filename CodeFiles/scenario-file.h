@@ -0,0 +1,401 @@
+#ifndef SCENARIO_FILE_H
+#define SCENARIO_FILE_H
+
+#include "ns3/core-module.h"
+
+#include "result-cache.h"
+
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace ns3;
+
+// Scenario description loaded from a JSON file with --scenario=file.json,
+// so one optimized build can run many configurations. Sections group the
+// program's own command-line options by concern; "attributes" sets any ns-3
+// attribute default by its full name:
+//
+//   {
+//     "topology":    { "numClients": 40, "radius": 5.0, "serverPosition": [0, -20, 0] },
+//     "channel":     { "lossExponent": 3.5, "nakagamiM0": 1.0 },
+//     "rateControl": { "rateManager": "ns3::MinstrelHtWifiManager" },
+//     "traffic":     { "downloadBytes": 10485760, "tcpVariant": "Cubic" },
+//     "measurement": { "stopTime": 30, "summaryFile": "summary.txt" },
+//     "attributes":  { "ns3::MinstrelHtWifiManager::LookAroundRate": 5 }
+//   }
+//
+// The whole file is checked before anything is applied: unknown sections,
+// options or attributes and values that do not parse as the option's type
+// are all reported together. Values are then applied exactly as if they had
+// been given on the command line, ahead of the real command line, which
+// therefore still overrides the file. Arrays of numbers become x:y:z values.
+class ScenarioFile
+{
+public:
+    // Registered on the plain CommandLine: the values the file resolves to
+    // are what goes into the result cache key, not its name
+    void AddOptions (CommandLine &cmd)
+    {
+        cmd.AddValue ("scenario", "JSON scenario description; command-line options override it", m_fileName);
+    }
+
+    // Replaces cmd.Parse (argc, argv)
+    void Parse (RecordingCommandLine &cmd, int argc, char *argv[])
+    {
+        cmd.Parse (argc, argv);
+        if (m_fileName.empty ())
+        {
+            return;
+        }
+
+        std::vector<std::string> args = {argv[0]};
+        std::vector<std::string> errors;
+        Load (cmd, args, errors);
+        if (!errors.empty ())
+        {
+            std::ostringstream os;
+            for (const std::string &error : errors)
+            {
+                os << "\n  " << m_fileName << ":" << error;
+            }
+            NS_FATAL_ERROR ("Invalid scenario file" << os.str ());
+        }
+
+        for (int i = 1; i < argc; ++i)
+        {
+            args.push_back (argv[i]);
+        }
+        cmd.Parse (args);
+    }
+
+private:
+    struct Json
+    {
+        enum Type
+        {
+            Null,
+            Bool,
+            Number,
+            String,
+            Array,
+            Object,
+        } type = Null;
+        std::string text; // number as written, decoded string, or true/false
+        std::vector<Json> items;
+        std::vector<std::pair<std::string, Json>> members;
+        int line = 0;
+    };
+
+    // Recursive descent over the subset of JSON a scenario needs (all of it but \u escapes)
+    class Parser
+    {
+    public:
+        Parser (const std::string &input)
+            : m_input (input)
+        {
+        }
+
+        bool Parse (Json &value, std::string &error)
+        {
+            bool ok = ParseValue (value);
+            SkipSpace ();
+            if (ok && m_pos != m_input.size ())
+            {
+                ok = Fail ("trailing characters");
+            }
+            if (!ok)
+            {
+                error = std::to_string (m_line) + ": " + m_error;
+            }
+            return ok;
+        }
+
+    private:
+        bool Fail (const std::string &error)
+        {
+            m_error = error;
+            return false;
+        }
+
+        void SkipSpace ()
+        {
+            while (m_pos < m_input.size () && std::isspace (static_cast<unsigned char> (m_input[m_pos])))
+            {
+                m_line += m_input[m_pos++] == '\n';
+            }
+        }
+
+        bool Consume (char c)
+        {
+            SkipSpace ();
+            if (m_pos < m_input.size () && m_input[m_pos] == c)
+            {
+                ++m_pos;
+                return true;
+            }
+            return false;
+        }
+
+        bool ParseValue (Json &value)
+        {
+            SkipSpace ();
+            value.line = m_line;
+            if (m_pos == m_input.size ())
+            {
+                return Fail ("unexpected end of file");
+            }
+            char c = m_input[m_pos];
+            if (c == '{')
+            {
+                return ParseObject (value);
+            }
+            if (c == '[')
+            {
+                return ParseArray (value);
+            }
+            if (c == '"')
+            {
+                value.type = Json::String;
+                return ParseString (value.text);
+            }
+            for (const char *word : {"true", "false", "null"})
+            {
+                if (m_input.compare (m_pos, std::strlen (word), word) == 0)
+                {
+                    m_pos += std::strlen (word);
+                    value.type = word[0] == 'n' ? Json::Null : Json::Bool;
+                    value.text = word;
+                    return true;
+                }
+            }
+            const char *start = m_input.c_str () + m_pos;
+            char *end = nullptr;
+            std::strtod (start, &end);
+            if (end == start)
+            {
+                return Fail (std::string ("unexpected character '") + c + "'");
+            }
+            value.type = Json::Number;
+            value.text.assign (start, end - start);
+            m_pos += end - start;
+            return true;
+        }
+
+        bool ParseString (std::string &text)
+        {
+            ++m_pos;
+            while (m_pos < m_input.size () && m_input[m_pos] != '"')
+            {
+                char c = m_input[m_pos++];
+                if (c == '\n')
+                {
+                    return Fail ("unterminated string");
+                }
+                if (c == '\\' && m_pos < m_input.size ())
+                {
+                    char e = m_input[m_pos++];
+                    c = e == 'n' ? '\n' : e == 't' ? '\t' : e;
+                }
+                text += c;
+            }
+            if (m_pos == m_input.size ())
+            {
+                return Fail ("unterminated string");
+            }
+            ++m_pos;
+            return true;
+        }
+
+        bool ParseArray (Json &value)
+        {
+            value.type = Json::Array;
+            ++m_pos;
+            if (Consume (']'))
+            {
+                return true;
+            }
+            do
+            {
+                value.items.emplace_back ();
+                if (!ParseValue (value.items.back ()))
+                {
+                    return false;
+                }
+            } while (Consume (','));
+            return Consume (']') || Fail ("expected ',' or ']'");
+        }
+
+        bool ParseObject (Json &value)
+        {
+            value.type = Json::Object;
+            ++m_pos;
+            if (Consume ('}'))
+            {
+                return true;
+            }
+            do
+            {
+                SkipSpace ();
+                if (m_pos == m_input.size () || m_input[m_pos] != '"')
+                {
+                    return Fail ("expected a quoted key");
+                }
+                value.members.emplace_back ();
+                if (!ParseString (value.members.back ().first))
+                {
+                    return false;
+                }
+                if (!Consume (':'))
+                {
+                    return Fail ("expected ':'");
+                }
+                if (!ParseValue (value.members.back ().second))
+                {
+                    return false;
+                }
+            } while (Consume (','));
+            return Consume ('}') || Fail ("expected ',' or '}'");
+        }
+
+        const std::string &m_input;
+        std::size_t m_pos = 0;
+        int m_line = 1;
+        std::string m_error;
+    };
+
+    // Command-line text of a scalar, or of a numeric array as x:y:z
+    static bool ToArgument (const Json &value, std::string &text)
+    {
+        if (value.type == Json::Bool || value.type == Json::Number || value.type == Json::String)
+        {
+            text = value.text;
+            return true;
+        }
+        if (value.type == Json::Array && !value.items.empty ())
+        {
+            text.clear ();
+            for (const Json &item : value.items)
+            {
+                if (item.type != Json::Number)
+                {
+                    return false;
+                }
+                text += (text.empty () ? "" : ":") + item.text;
+            }
+            return true;
+        }
+        return false;
+    }
+
+    // Same checks Config::SetDefaultFailSafe makes, without applying anything
+    static bool IsValidAttribute (const std::string &fullName, const std::string &text, std::string &error)
+    {
+        std::size_t split = fullName.rfind ("::");
+        TypeId tid;
+        if (split == std::string::npos || !TypeId::LookupByNameFailSafe (fullName.substr (0, split), &tid))
+        {
+            error = "no such type";
+            return false;
+        }
+        TypeId::AttributeInformation info;
+        if (!tid.LookupAttributeByName (fullName.substr (split + 2), &info))
+        {
+            error = "no such attribute";
+            return false;
+        }
+        if (!info.checker->CreateValidValue (StringValue (text)))
+        {
+            error = "invalid value '" + text + "' for " + info.checker->GetValueTypeName ();
+            return false;
+        }
+        return true;
+    }
+
+    void Load (const RecordingCommandLine &cmd, std::vector<std::string> &args, std::vector<std::string> &errors)
+    {
+        std::ifstream in (m_fileName);
+        if (!in)
+        {
+            errors.push_back (" cannot be read");
+            return;
+        }
+        std::stringstream contents;
+        contents << in.rdbuf ();
+        std::string input = contents.str ();
+
+        Json root;
+        std::string error;
+        if (!Parser (input).Parse (root, error))
+        {
+            errors.push_back (error);
+            return;
+        }
+        if (root.type != Json::Object)
+        {
+            errors.push_back (std::to_string (root.line) + ": the scenario must be an object of sections");
+            return;
+        }
+
+        for (const auto &section : root.members)
+        {
+            const std::string &name = section.first;
+            std::string where = std::to_string (section.second.line) + ": " + name;
+            bool attributes = name == "attributes";
+            if (!attributes && name != "topology" && name != "channel" && name != "rateControl" &&
+                name != "traffic" && name != "measurement")
+            {
+                errors.push_back (where + ": unknown section (topology, channel, rateControl, traffic, measurement or attributes)");
+                continue;
+            }
+            if (section.second.type != Json::Object)
+            {
+                errors.push_back (where + ": a section must be an object");
+                continue;
+            }
+
+            for (const auto &entry : section.second.members)
+            {
+                const std::string &key = entry.first;
+                std::string path = std::to_string (entry.second.line) + ": " + name + "." + key;
+                std::string text;
+                if (!ToArgument (entry.second, text))
+                {
+                    errors.push_back (path + ": expected a number, string, boolean or array of numbers");
+                }
+                else if (attributes)
+                {
+                    if (IsValidAttribute (key, text, error))
+                    {
+                        args.push_back ("--" + key + "=" + text);
+                    }
+                    else
+                    {
+                        errors.push_back (path + ": " + error);
+                    }
+                }
+                else if (!cmd.HasValue (key))
+                {
+                    errors.push_back (path + ": not an option of this scenario");
+                }
+                else if (!cmd.IsValid (key, text))
+                {
+                    errors.push_back (path + ": invalid value '" + text + "'");
+                }
+                else
+                {
+                    args.push_back ("--" + key + "=" + text);
+                }
+            }
+        }
+    }
+
+    std::string m_fileName = "";
+};
+
+#endif // SCENARIO_FILE_H
@@ -0,0 +1,256 @@
+#ifndef SCENARIO_LOG_H
+#define SCENARIO_LOG_H
+
+#include "ns3/core-module.h"
+
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+using namespace ns3;
+
+// Hot-path logging for the scenarios. Sites above SCENARIO_LOG_MAX_LEVEL are
+// discarded at compile time (arguments are not even evaluated); the remaining
+// ones cost one mask test unless their category is enabled with
+// --logCategories. Enabled sites append a fixed 32-byte record (time, node,
+// site, two arguments) to an in-memory ring that is written to --logRing at
+// exit, on NS_FATAL_ERROR/abort and on crashes; nothing goes to stderr.
+// Format the dump with logDump.py.
+//
+// Build with e.g. CXXFLAGS=-DSCENARIO_LOG_MAX_LEVEL=0 to keep errors only.
+#ifndef SCENARIO_LOG_MAX_LEVEL
+#define SCENARIO_LOG_MAX_LEVEL 3
+#endif
+
+enum class ScenarioLevel : uint8_t
+{
+    Error = 0,
+    Warn = 1,
+    Info = 2,
+    Debug = 3,
+    Trace = 4,
+};
+
+enum class ScenarioCategory : uint8_t
+{
+    Scenario = 0,
+    Mac = 1,
+    Phy = 2,
+    Tcp = 3,
+    Queue = 4,
+    App = 5,
+};
+
+static const char *const kScenarioCategoryNames[] = {"Scenario", "Mac", "Phy", "Tcp", "Queue", "App"};
+
+struct ScenarioLogRecord
+{
+    int64_t timeNs;
+    uint32_t node;
+    uint16_t site;
+    uint8_t category;
+    uint8_t level;
+    uint64_t args[2]; // integers, or doubles bit for bit; the format says which
+};
+
+static_assert (sizeof (ScenarioLogRecord) == 32, "log records are 32 bytes");
+
+class ScenarioLog
+{
+public:
+    static ScenarioLog &Get ()
+    {
+        static ScenarioLog log;
+        return log;
+    }
+
+    // Registered on the plain CommandLine, so they stay out of the result cache key
+    void AddOptions (CommandLine &cmd)
+    {
+        cmd.AddValue ("logCategories", "Log categories recorded into the ring: all, or a list of Scenario,Mac,Phy,Tcp,Queue,App", m_categories);
+        cmd.AddValue ("logRing", "File the log ring is written to at exit or on a crash", m_fileName);
+        cmd.AddValue ("logRingRecords", "Capacity of the log ring in records (rounded up to a power of two)", m_capacity);
+    }
+
+    // Call after Parse (); installs the exit and crash handlers when anything is enabled
+    void Start ()
+    {
+        Start (m_categories, m_fileName);
+    }
+
+    void Start (const std::string &categories, const std::string &fileName)
+    {
+        m_categories = categories;
+        m_fileName = fileName;
+        m_mask = 0;
+        std::stringstream ss (m_categories);
+        std::string name;
+        while (std::getline (ss, name, ','))
+        {
+            for (uint32_t c = 0; c < sizeof (kScenarioCategoryNames) / sizeof (kScenarioCategoryNames[0]); ++c)
+            {
+                if (name == "all" || name == kScenarioCategoryNames[c])
+                {
+                    m_mask |= 1u << c;
+                }
+            }
+        }
+        if (m_mask == 0)
+        {
+            return;
+        }
+
+        uint32_t capacity = 1;
+        while (capacity < m_capacity)
+        {
+            capacity <<= 1;
+        }
+        m_ring.assign (capacity, ScenarioLogRecord ());
+        m_fileName.copy (m_path, sizeof (m_path) - 1);
+
+        std::atexit ([] () { Get ().Dump (); });
+        for (int sig : {SIGSEGV, SIGBUS, SIGFPE, SIGILL, SIGABRT})
+        {
+            signal (sig, &ScenarioLog::OnSignal);
+        }
+    }
+
+    bool IsEnabled (ScenarioCategory category) const
+    {
+        return m_mask & (1u << static_cast<uint32_t> (category));
+    }
+
+    uint16_t RegisterSite (const char *format)
+    {
+        m_sites.push_back (format);
+        return m_sites.size () - 1;
+    }
+
+    template <typename A = uint64_t, typename B = uint64_t>
+    void Record (ScenarioLevel level, ScenarioCategory category, uint16_t site, A a = 0, B b = 0)
+    {
+        ScenarioLogRecord &record = m_ring[m_written++ & (m_ring.size () - 1)];
+        record.timeNs = Simulator::Now ().GetNanoSeconds ();
+        record.node = Simulator::GetContext ();
+        record.site = site;
+        record.category = static_cast<uint8_t> (category);
+        record.level = static_cast<uint8_t> (level);
+        record.args[0] = ToSlot (a);
+        record.args[1] = ToSlot (b);
+    }
+
+    // Only write(2) and no allocation, so it can run from a signal handler
+    void Dump ()
+    {
+        if (m_dumped || m_ring.empty ())
+        {
+            return;
+        }
+        m_dumped = true;
+
+        int fd = open (m_path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0)
+        {
+            return;
+        }
+        uint64_t capacity = m_ring.size ();
+        uint32_t nSites = m_sites.size ();
+        Write (fd, "NS3LRING", 8);
+        Write (fd, &m_written, sizeof (m_written));
+        Write (fd, &capacity, sizeof (capacity));
+        Write (fd, &nSites, sizeof (nSites));
+        for (const char *format : m_sites)
+        {
+            uint16_t length = std::strlen (format);
+            Write (fd, &length, sizeof (length));
+            Write (fd, format, length);
+        }
+
+        // Oldest record first
+        uint64_t count = m_written < capacity ? m_written : capacity;
+        uint64_t first = m_written - count;
+        for (uint64_t i = 0; i < count; ++i)
+        {
+            Write (fd, &m_ring[(first + i) & (capacity - 1)], sizeof (ScenarioLogRecord));
+        }
+        close (fd);
+    }
+
+private:
+    template <typename T>
+    static uint64_t ToSlot (T value)
+    {
+        if constexpr (std::is_floating_point<T>::value)
+        {
+            double d = value;
+            uint64_t bits;
+            std::memcpy (&bits, &d, sizeof (bits));
+            return bits;
+        }
+        else
+        {
+            return static_cast<uint64_t> (value);
+        }
+    }
+
+    static void Write (int fd, const void *data, std::size_t size)
+    {
+        const char *p = static_cast<const char *> (data);
+        while (size > 0)
+        {
+            ssize_t n = write (fd, p, size);
+            if (n <= 0)
+            {
+                return;
+            }
+            p += n;
+            size -= n;
+        }
+    }
+
+    static void OnSignal (int sig)
+    {
+        Get ().Dump ();
+        signal (sig, SIG_DFL);
+        raise (sig);
+    }
+
+    std::string m_categories = "";
+    std::string m_fileName = "scenario-log.bin";
+    uint32_t m_capacity = 1 << 16;
+    char m_path[4096] = {};
+    uint32_t m_mask = 0;
+    uint64_t m_written = 0;
+    bool m_dumped = false;
+    std::vector<ScenarioLogRecord> m_ring;
+    std::vector<const char *> m_sites;
+};
+
+// SCENARIO_LOG (Debug, Mac, "station %u airtime %f us", station, us): printf-style
+// format (%d/%u/%x integers, %f/%g/%e doubles) with up to two arguments
+#define SCENARIO_LOG_GATED(maxLevel, level, category, format, ...)                                     \
+    do                                                                                                 \
+    {                                                                                                  \
+        if constexpr (static_cast<int> (ScenarioLevel::level) <= (maxLevel))                          \
+        {                                                                                              \
+            if (ScenarioLog::Get ().IsEnabled (ScenarioCategory::category))                            \
+            {                                                                                          \
+                static const uint16_t scenarioLogSite = ScenarioLog::Get ().RegisterSite (format);     \
+                ScenarioLog::Get ().Record (ScenarioLevel::level, ScenarioCategory::category,          \
+                                            scenarioLogSite, ##__VA_ARGS__);                           \
+            }                                                                                          \
+        }                                                                                              \
+    } while (false)
+
+#define SCENARIO_LOG(level, category, format, ...)                                                     \
+    SCENARIO_LOG_GATED (SCENARIO_LOG_MAX_LEVEL, level, category, format, ##__VA_ARGS__)
+
+#endif // SCENARIO_LOG_H
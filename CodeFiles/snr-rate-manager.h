@@ -0,0 +1,223 @@
+#ifndef SNR_RATE_MANAGER_H
+#define SNR_RATE_MANAGER_H
+
+#include "ns3/core-module.h"
+#include "ns3/wifi-module.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+
+using namespace ns3;
+
+// Lowest SNR (dB) at which each HT MCS (0..7, one spatial stream) delivers a
+// 1500-byte frame with at most 10% PER, from the NistErrorRateModel BER and
+// convolutional-code bounds. Fixed at compile time; the step-up hysteresis is
+// what absorbs the model differences and fading.
+constexpr std::array<double, 8> kHtMcsSnrThresholdDb = {4.0, 7.0, 9.9, 13.5, 16.6, 21.4, 22.6, 23.8};
+
+// Dense SNR -> best MCS table, so a rate decision is one index computation;
+// an SNR is rounded down to the 0.25 dB grid, which errs towards the lower MCS
+constexpr double kSnrTableMinDb = -5.0;
+constexpr double kSnrTableStepDb = 0.25;
+constexpr std::size_t kSnrTableSize = 181; // -5 .. 40 dB
+
+constexpr std::array<uint8_t, kSnrTableSize> MakeSnrToMcsTable ()
+{
+    std::array<uint8_t, kSnrTableSize> table {};
+    for (std::size_t i = 0; i < kSnrTableSize; ++i)
+    {
+        double snrDb = kSnrTableMinDb + i * kSnrTableStepDb;
+        uint8_t mcs = 0;
+        for (uint8_t m = 0; m < kHtMcsSnrThresholdDb.size (); ++m)
+        {
+            if (snrDb >= kHtMcsSnrThresholdDb[m])
+            {
+                mcs = m;
+            }
+        }
+        table[i] = mcs;
+    }
+    return table;
+}
+
+constexpr std::array<uint8_t, kSnrTableSize> kSnrToMcs = MakeSnrToMcsTable ();
+static_assert (kSnrToMcs[0] == 0 && kSnrToMcs[kSnrTableSize - 1] == 7, "SNR table must span MCS 0 to 7");
+
+// Rate control for static topologies: the data rate follows the SNR the peer
+// measured on our last acknowledged frame (or, before the first one, the SNR
+// of the peer's own frames) through the table above. There are no sampling
+// frames, statistics tables or timers, and the right MCS is used from the
+// first acknowledgement instead of after Minstrel's first update intervals.
+// Stepping up needs HysteresisDb of margin over the next threshold; stepping
+// down happens as soon as the SNR falls below the current one, or after
+// FailureThreshold consecutive failed transmissions. Peers without HT get
+// the default mode.
+class SnrTableWifiManager : public WifiRemoteStationManager
+{
+public:
+    static TypeId GetTypeId ()
+    {
+        static TypeId tid = TypeId ("ns3::SnrTableWifiManager")
+                                .SetParent<WifiRemoteStationManager> ()
+                                .SetGroupName ("Wifi")
+                                .AddConstructor<SnrTableWifiManager> ()
+                                .AddAttribute ("HysteresisDb",
+                                               "Margin over the next MCS threshold needed to step up",
+                                               DoubleValue (1.0),
+                                               MakeDoubleAccessor (&SnrTableWifiManager::m_hysteresisDb),
+                                               MakeDoubleChecker<double> (0.0))
+                                .AddAttribute ("FailureThreshold",
+                                               "Consecutive failed transmissions that step the MCS down by one",
+                                               UintegerValue (2),
+                                               MakeUintegerAccessor (&SnrTableWifiManager::m_failureThreshold),
+                                               MakeUintegerChecker<uint32_t> (1));
+        return tid;
+    }
+
+    // Best MCS for an SNR in dB
+    static uint8_t LookupMcs (double snrDb)
+    {
+        double index = std::floor ((snrDb - kSnrTableMinDb) / kSnrTableStepDb);
+        return kSnrToMcs[static_cast<std::size_t> (std::clamp (index, 0.0, kSnrTableSize - 1.0))];
+    }
+
+private:
+    struct Station : public WifiRemoteStation
+    {
+        uint8_t mcs = 0;
+        uint32_t failures = 0;
+        bool measured = false; // seen an SNR for our own frames
+    };
+
+    WifiRemoteStation *DoCreateStation () const override
+    {
+        return new Station ();
+    }
+
+    uint8_t MaxMcs (Station *station)
+    {
+        uint8_t best = 0;
+        for (uint8_t i = 0; i < GetNMcsSupported (station); ++i)
+        {
+            WifiMode mode = GetMcsSupported (station, i);
+            if (mode.GetModulationClass () == WIFI_MOD_CLASS_HT && mode.GetMcsValue () < 8)
+            {
+                best = std::max (best, mode.GetMcsValue ());
+            }
+        }
+        return best;
+    }
+
+    void Update (Station *station, double snr)
+    {
+        if (snr <= 0)
+        {
+            return;
+        }
+        double snrDb = 10.0 * std::log10 (snr);
+        uint8_t down = LookupMcs (snrDb);
+        uint8_t up = LookupMcs (snrDb - m_hysteresisDb);
+        if (!station->measured || down < station->mcs)
+        {
+            station->mcs = down;
+        }
+        else if (up > station->mcs)
+        {
+            station->mcs = up;
+        }
+        station->mcs = std::min (station->mcs, MaxMcs (station));
+        station->failures = 0;
+    }
+
+    void Failed (Station *station)
+    {
+        if (++station->failures >= m_failureThreshold)
+        {
+            station->mcs = station->mcs > 0 ? station->mcs - 1 : 0;
+            station->failures = 0;
+        }
+    }
+
+    void DoReportRxOk (WifiRemoteStation *st, double rxSnr, WifiMode txMode) override
+    {
+        Station *station = static_cast<Station *> (st);
+        if (!station->measured)
+        {
+            Update (station, rxSnr);
+        }
+    }
+
+    void DoReportRtsFailed (WifiRemoteStation *st) override
+    {
+    }
+
+    void DoReportDataFailed (WifiRemoteStation *st) override
+    {
+        Failed (static_cast<Station *> (st));
+    }
+
+    void DoReportRtsOk (WifiRemoteStation *st, double ctsSnr, WifiMode ctsMode, double rtsSnr) override
+    {
+    }
+
+    void DoReportDataOk (WifiRemoteStation *st, double ackSnr, WifiMode ackMode, double dataSnr,
+                         uint16_t dataChannelWidth, uint8_t dataNss) override
+    {
+        Station *station = static_cast<Station *> (st);
+        Update (station, dataSnr);
+        station->measured = station->measured || dataSnr > 0;
+    }
+
+    void DoReportAmpduTxStatus (WifiRemoteStation *st, uint16_t nSuccessfulMpdus, uint16_t nFailedMpdus,
+                                double rxSnr, double dataSnr, uint16_t dataChannelWidth, uint8_t dataNss) override
+    {
+        Station *station = static_cast<Station *> (st);
+        if (nSuccessfulMpdus == 0)
+        {
+            Failed (station);
+            return;
+        }
+        Update (station, dataSnr);
+        station->measured = station->measured || dataSnr > 0;
+    }
+
+    void DoReportFinalRtsFailed (WifiRemoteStation *st) override
+    {
+    }
+
+    void DoReportFinalDataFailed (WifiRemoteStation *st) override
+    {
+        static_cast<Station *> (st)->failures = 0;
+    }
+
+    WifiTxVector DoGetDataTxVector (WifiRemoteStation *st, uint16_t allowedWidth) override
+    {
+        Station *station = static_cast<Station *> (st);
+        uint16_t width = std::min ({allowedWidth, GetChannelWidth (station), GetPhy ()->GetChannelWidth ()});
+        WifiMode mode = GetHtSupported (station) ? HtPhy::GetHtMcs (station->mcs) : GetDefaultMode ();
+        return WifiTxVector (mode, GetDefaultTxPowerLevel (),
+                             GetPreambleForTransmission (mode.GetModulationClass (), GetShortPreambleEnabled ()),
+                             ConvertGuardIntervalToNanoSeconds (mode, GetShortGuardIntervalSupported (station),
+                                                                NanoSeconds (GetGuardInterval (station))),
+                             GetNumberOfAntennas (), 1, 0, GetPhy ()->GetTxBandwidth (mode, width),
+                             GetAggregation (station));
+    }
+
+    WifiTxVector DoGetRtsTxVector (WifiRemoteStation *st) override
+    {
+        WifiMode mode = GetDefaultMode ();
+        return WifiTxVector (mode, GetDefaultTxPowerLevel (),
+                             GetPreambleForTransmission (mode.GetModulationClass (), GetShortPreambleEnabled ()),
+                             800, 1, 1, 0, GetPhy ()->GetTxBandwidth (mode, GetChannelWidth (st)),
+                             GetAggregation (st));
+    }
+
+    double m_hysteresisDb = 1.0;
+    uint32_t m_failureThreshold = 2;
+};
+
+NS_OBJECT_ENSURE_REGISTERED (SnrTableWifiManager);
+
+#endif // SNR_RATE_MANAGER_H
@@ -0,0 +1,314 @@
+#ifndef SOAK_MONITOR_H
+#define SOAK_MONITOR_H
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+
+#include "pooled-alloc.h"
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+using namespace ns3;
+
+// Memory watch for long runs (--soak=s). Every s simulated seconds it samples
+// the process's resident set, the heap blocks live (PooledAllocator counts
+// them from Install on, whether or not the pools are on) and the ns-3
+// Objects reachable from the node and channel lists, counted by TypeId.
+// Objects are found the way Config paths find them: aggregates, and every
+// Pointer and object-container attribute. A quantity that never fell over
+// the last Window samples and ended higher than it started is reported as
+// growing; ramp-up is over once a full window stays flat. Each series keeps
+// only Window+1 values, so the monitor itself stays the same size however
+// long the run.
+class SoakMonitor
+{
+public:
+    // Registered on the plain CommandLine: sampling does not change results
+    void AddOptions (CommandLine &cmd)
+    {
+        cmd.AddValue ("soak", "Sample memory and live objects every N simulated seconds (0 to disable)", m_interval);
+        cmd.AddValue ("soakWindow", "Report quantities that grew over this many consecutive samples", m_window);
+        cmd.AddValue ("soakFile", "File to write the soak samples to as they are taken (empty to disable)", m_fileName);
+    }
+
+    bool IsEnabled () const
+    {
+        return m_interval > 0;
+    }
+
+    // Before the topology is built, so the heap count includes its blocks
+    void Install ()
+    {
+        if (IsEnabled ())
+        {
+            PooledAllocator::EnableCounters ();
+        }
+    }
+
+    // After the topology is built, so the first sample is the baseline
+    void Start ()
+    {
+        if (!IsEnabled ())
+        {
+            return;
+        }
+        if (m_window < 2)
+        {
+            NS_FATAL_ERROR ("--soakWindow must be at least 2 samples");
+        }
+        // RSS, heap blocks, then one series per registered TypeId (by uid - 1)
+        m_series.assign (kFirstType + TypeId::GetRegisteredN (), Series ());
+        for (auto &series : m_series)
+        {
+            series.values.assign (m_window + 1, 0);
+        }
+        if (!m_fileName.empty ())
+        {
+            m_file.open (m_fileName);
+            if (!m_file)
+            {
+                NS_FATAL_ERROR ("Cannot open soak file " << m_fileName);
+            }
+            m_file << "time_s\tquantity\tvalue" << std::endl;
+        }
+        Simulator::ScheduleNow (&SoakMonitor::Sample, this);
+    }
+
+    void Report (std::ostream &os) const
+    {
+        if (!IsEnabled () || m_samples == 0)
+        {
+            return;
+        }
+        const Series &rss = m_series[kRss];
+        const Series &heap = m_series[kHeap];
+        os << "Soak: " << m_samples << " samples, rss " << rss.first / 1048576.0 << " -> " << rss.Last () / 1048576.0
+           << " MiB (peak " << rss.peak / 1048576.0 << "), heap blocks " << heap.first << " -> " << heap.Last ()
+           << " (peak " << heap.peak << "), objects " << m_firstObjects << " -> " << m_objects << std::endl;
+        std::string growing = Growing ();
+        os << "Soak: " << (growing.empty () ? "no monotonic growth over the last window" : "growing: " + growing)
+           << std::endl;
+    }
+
+private:
+    static constexpr uint32_t kRss = 0;
+    static constexpr uint32_t kHeap = 1;
+    static constexpr uint32_t kFirstType = 2;
+
+    // The last Window+1 values in a ring, for the growth test
+    struct Series
+    {
+        std::vector<uint64_t> values;
+        uint32_t next = 0;
+        uint32_t filled = 0;
+        uint64_t first = 0;
+        uint64_t peak = 0;
+
+        void Add (uint64_t value)
+        {
+            if (filled == 0)
+            {
+                first = value;
+            }
+            values[next] = value;
+            next = (next + 1) % values.size ();
+            filled += filled < values.size ();
+            peak = std::max (peak, value);
+        }
+
+        uint64_t Last () const
+        {
+            return values[(next + values.size () - 1) % values.size ()];
+        }
+
+        // Never fell over the whole window and rose across it
+        bool IsGrowing () const
+        {
+            if (filled < values.size ())
+            {
+                return false;
+            }
+            for (uint32_t i = 1; i < values.size (); ++i)
+            {
+                if (values[(next + i) % values.size ()] < values[(next + i - 1) % values.size ()])
+                {
+                    return false;
+                }
+            }
+            return Last () > values[next];
+        }
+
+        uint64_t Growth () const
+        {
+            return Last () - values[next];
+        }
+    };
+
+    void Sample ()
+    {
+        PooledAllocator::Counters heap = PooledAllocator::GetCounters ();
+        m_series[kRss].Add (ResidentBytes ());
+        // Blocks from before Install may be freed after it
+        m_series[kHeap].Add (heap.allocations > heap.frees ? heap.allocations - heap.frees : 0);
+
+        m_counts.assign (m_series.size () - kFirstType, 0);
+        for (uint32_t i = 0; i < NodeList::GetNNodes (); ++i)
+        {
+            Visit (NodeList::GetNode (i));
+        }
+        for (uint32_t i = 0; i < ChannelList::GetNChannels (); ++i)
+        {
+            Visit (ChannelList::GetChannel (i));
+        }
+        m_objects = m_visited.size ();
+        m_visited.clear ();
+        for (uint32_t i = 0; i < m_counts.size (); ++i)
+        {
+            m_series[kFirstType + i].Add (m_counts[i]);
+        }
+        if (m_samples++ == 0)
+        {
+            m_firstObjects = m_objects;
+        }
+
+        double now = Simulator::Now ().GetSeconds ();
+        char line[160];
+        std::snprintf (line, sizeof (line), "Soak %.0f s: rss %.1f MiB, %lu heap blocks, %lu objects", now,
+                       m_series[kRss].Last () / 1048576.0, static_cast<unsigned long> (m_series[kHeap].Last ()),
+                       static_cast<unsigned long> (m_objects));
+        std::cerr << line;
+        std::string growing = Growing ();
+        if (!growing.empty ())
+        {
+            std::cerr << ", growing: " << growing;
+        }
+        std::cerr << std::endl;
+
+        if (m_file.is_open ())
+        {
+            m_file << now << "\trss_bytes\t" << m_series[kRss].Last () << "\n"
+                   << now << "\theap_blocks\t" << m_series[kHeap].Last () << "\n";
+            for (uint32_t i = 0; i < m_counts.size (); ++i)
+            {
+                if (m_counts[i] > 0)
+                {
+                    m_file << now << "\t" << TypeId::GetRegistered (i).GetName () << "\t" << m_counts[i] << "\n";
+                }
+            }
+            m_file.flush (); // a run killed hours in still leaves its samples
+        }
+
+        Simulator::Schedule (Seconds (m_interval), &SoakMonitor::Sample, this);
+    }
+
+    std::string Growing () const
+    {
+        std::string growing;
+        auto add = [&growing] (const std::string &item) { growing += (growing.empty () ? "" : ", ") + item; };
+        if (m_series[kRss].IsGrowing ())
+        {
+            add ("rss +" + std::to_string (m_series[kRss].Growth () / 1024) + " KiB");
+        }
+        if (m_series[kHeap].IsGrowing ())
+        {
+            add ("heap blocks +" + std::to_string (m_series[kHeap].Growth ()));
+        }
+        for (uint32_t i = kFirstType; i < m_series.size (); ++i)
+        {
+            if (m_series[i].IsGrowing ())
+            {
+                add (TypeId::GetRegistered (i - kFirstType).GetName () + " +" + std::to_string (m_series[i].Growth ()));
+            }
+        }
+        return growing;
+    }
+
+    void Visit (Ptr<const Object> object)
+    {
+        if (!object || !m_visited.insert (PeekPointer (object)).second)
+        {
+            return;
+        }
+        // Types registered after Start (template instances) are not counted
+        TypeId instanceTid = object->GetInstanceTypeId ();
+        if (instanceTid.GetUid () >= 1 && instanceTid.GetUid () <= m_counts.size ())
+        {
+            m_counts[instanceTid.GetUid () - 1]++;
+        }
+
+        Object::AggregateIterator aggregates = object->GetAggregateIterator ();
+        while (aggregates.HasNext ())
+        {
+            Visit (aggregates.Next ());
+        }
+
+        for (TypeId tid = instanceTid;; tid = tid.GetParent ())
+        {
+            for (std::size_t i = 0; i < tid.GetAttributeN (); ++i)
+            {
+                TypeId::AttributeInformation info = tid.GetAttribute (i);
+                if (!(info.flags & TypeId::ATTR_GET) || !info.accessor->HasGetter ())
+                {
+                    continue;
+                }
+                if (dynamic_cast<const PointerChecker *> (PeekPointer (info.checker)))
+                {
+                    PointerValue value;
+                    info.accessor->Get (PeekPointer (object), value);
+                    Visit (value.Get<Object> ());
+                }
+                else if (dynamic_cast<const ObjectPtrContainerChecker *> (PeekPointer (info.checker)))
+                {
+                    ObjectPtrContainerValue container;
+                    info.accessor->Get (PeekPointer (object), container);
+                    for (auto it = container.Begin (); it != container.End (); ++it)
+                    {
+                        Visit (it->second);
+                    }
+                }
+            }
+            if (!tid.HasParent () || tid.GetParent () == tid)
+            {
+                break;
+            }
+        }
+    }
+
+    static uint64_t ResidentBytes ()
+    {
+        unsigned long size = 0;
+        unsigned long resident = 0;
+        std::FILE *statm = std::fopen ("/proc/self/statm", "r");
+        if (statm)
+        {
+            if (std::fscanf (statm, "%lu %lu", &size, &resident) != 2)
+            {
+                resident = 0;
+            }
+            std::fclose (statm);
+        }
+        return uint64_t (resident) * sysconf (_SC_PAGESIZE);
+    }
+
+    double m_interval = 0.0;
+    uint32_t m_window = 5;
+    std::string m_fileName;
+    std::ofstream m_file;
+    std::vector<Series> m_series;
+    std::vector<uint64_t> m_counts;
+    std::unordered_set<const Object *> m_visited;
+    uint64_t m_objects = 0;
+    uint64_t m_firstObjects = 0;
+    uint64_t m_samples = 0;
+};
+
+#endif // SOAK_MONITOR_H
@@ -0,0 +1,548 @@
+#ifndef STREAMING_STATS_H
+#define STREAMING_STATS_H
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <limits>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Count, mean and variance with Welford's update. Two summaries combine with
+// Chan's pairwise formula, so runs can be merged without their samples.
+class RunningStats
+{
+public:
+    void Add (double x)
+    {
+        m_count++;
+        double delta = x - m_mean;
+        m_mean += delta / m_count;
+        m_m2 += delta * (x - m_mean);
+        m_min = std::min (m_min, x);
+        m_max = std::max (m_max, x);
+    }
+
+    void Merge (const RunningStats &other)
+    {
+        if (other.m_count == 0)
+        {
+            return;
+        }
+        double count = m_count + other.m_count;
+        double delta = other.m_mean - m_mean;
+        m_m2 += other.m_m2 + delta * delta * m_count * other.m_count / count;
+        m_mean += delta * other.m_count / count;
+        m_count += other.m_count;
+        m_min = std::min (m_min, other.m_min);
+        m_max = std::max (m_max, other.m_max);
+    }
+
+    uint64_t GetCount () const { return m_count; }
+    double GetMean () const { return m_mean; }
+    double GetVariance () const { return m_count > 1 ? m_m2 / (m_count - 1) : 0.0; }
+    double GetStddev () const { return std::sqrt (GetVariance ()); }
+    double GetMin () const { return m_count ? m_min : 0.0; }
+    double GetMax () const { return m_count ? m_max : 0.0; }
+
+    void Write (std::ostream &os) const
+    {
+        os << m_count << " " << m_mean << " " << m_m2 << " " << GetMin () << " " << GetMax ();
+    }
+
+    void Read (std::istream &is)
+    {
+        is >> m_count >> m_mean >> m_m2 >> m_min >> m_max;
+        if (m_count == 0)
+        {
+            *this = RunningStats ();
+        }
+    }
+
+private:
+    uint64_t m_count = 0;
+    double m_mean = 0.0;
+    double m_m2 = 0.0;
+    double m_min = std::numeric_limits<double>::infinity ();
+    double m_max = -std::numeric_limits<double>::infinity ();
+};
+
+// Merging t-digest (Dunning) with the arcsine scale function: a few hundred
+// centroids at most, finer towards both tails, so P95/P99 stay accurate.
+// Digests merge by re-compressing the union of their centroids.
+class QuantileDigest
+{
+public:
+    struct Centroid
+    {
+        double mean;
+        double weight;
+    };
+
+    explicit QuantileDigest (double compression = 100.0)
+        : m_compression (compression)
+    {
+    }
+
+    void Add (double x, double weight = 1.0)
+    {
+        m_buffer.push_back ({x, weight});
+        m_min = std::min (m_min, x);
+        m_max = std::max (m_max, x);
+        if (m_buffer.size () >= 8 * static_cast<std::size_t> (m_compression))
+        {
+            Compress ();
+        }
+    }
+
+    void Merge (const QuantileDigest &other)
+    {
+        m_buffer.insert (m_buffer.end (), other.m_centroids.begin (), other.m_centroids.end ());
+        m_buffer.insert (m_buffer.end (), other.m_buffer.begin (), other.m_buffer.end ());
+        m_min = std::min (m_min, other.m_min);
+        m_max = std::max (m_max, other.m_max);
+        Compress ();
+    }
+
+    void Compress ()
+    {
+        if (m_buffer.empty ())
+        {
+            return;
+        }
+
+        std::vector<Centroid> all;
+        all.reserve (m_centroids.size () + m_buffer.size ());
+        all.insert (all.end (), m_centroids.begin (), m_centroids.end ());
+        all.insert (all.end (), m_buffer.begin (), m_buffer.end ());
+        m_buffer.clear ();
+        std::sort (all.begin (), all.end (),
+                   [] (const Centroid &a, const Centroid &b) { return a.mean < b.mean; });
+
+        double total = 0.0;
+        for (const auto &c : all)
+        {
+            total += c.weight;
+        }
+
+        m_centroids.clear ();
+        Centroid current = all[0];
+        double weightSoFar = 0.0;
+        double limit = total * KInverse (K (0.0) + 1.0);
+
+        for (std::size_t i = 1; i < all.size (); ++i)
+        {
+            if (weightSoFar + current.weight + all[i].weight <= limit)
+            {
+                current.weight += all[i].weight;
+                current.mean += (all[i].mean - current.mean) * all[i].weight / current.weight;
+            }
+            else
+            {
+                weightSoFar += current.weight;
+                m_centroids.push_back (current);
+                limit = total * KInverse (K (weightSoFar / total) + 1.0);
+                current = all[i];
+            }
+        }
+        m_centroids.push_back (current);
+        m_total = total;
+    }
+
+    double GetTotalWeight ()
+    {
+        Compress ();
+        return m_total;
+    }
+
+    // Interpolates between centroid centres, and towards min/max in the tails
+    double Quantile (double q)
+    {
+        Compress ();
+        if (m_centroids.empty ())
+        {
+            return 0.0;
+        }
+
+        double target = q * m_total;
+        double cumulative = 0.0;
+        double prevCenter = 0.0;
+        double prevMean = m_min;
+
+        for (const auto &c : m_centroids)
+        {
+            double center = cumulative + c.weight / 2.0;
+            if (target < center)
+            {
+                double span = center - prevCenter;
+                double fraction = span > 0 ? (target - prevCenter) / span : 0.0;
+                return prevMean + fraction * (c.mean - prevMean);
+            }
+            cumulative += c.weight;
+            prevCenter = center;
+            prevMean = c.mean;
+        }
+
+        double span = m_total - prevCenter;
+        double fraction = span > 0 ? (target - prevCenter) / span : 1.0;
+        return prevMean + std::min (1.0, fraction) * (m_max - prevMean);
+    }
+
+    // Empirical CDF as (value, cumulative fraction) at every centroid centre
+    std::vector<std::pair<double, double>> Ecdf ()
+    {
+        Compress ();
+        std::vector<std::pair<double, double>> points;
+        if (m_centroids.empty ())
+        {
+            return points;
+        }
+
+        points.emplace_back (m_min, 0.0);
+        double cumulative = 0.0;
+        for (const auto &c : m_centroids)
+        {
+            points.emplace_back (c.mean, (cumulative + c.weight / 2.0) / m_total);
+            cumulative += c.weight;
+        }
+        points.emplace_back (m_max, 1.0);
+        return points;
+    }
+
+    void Write (std::ostream &os)
+    {
+        Compress ();
+        bool empty = m_centroids.empty ();
+        os << "digest " << m_compression << " " << m_centroids.size () << " " << (empty ? 0.0 : m_min)
+           << " " << (empty ? 0.0 : m_max) << "\n";
+        for (const auto &c : m_centroids)
+        {
+            os << "centroid " << c.mean << " " << c.weight << "\n";
+        }
+    }
+
+    void Read (std::istream &is)
+    {
+        std::size_t n = 0;
+        std::string tag;
+        is >> m_compression >> n >> m_min >> m_max;
+        m_centroids.clear ();
+        m_buffer.clear ();
+        m_total = 0.0;
+        for (std::size_t i = 0; i < n && is >> tag; ++i)
+        {
+            Centroid c;
+            is >> c.mean >> c.weight;
+            m_centroids.push_back (c);
+            m_total += c.weight;
+        }
+        if (m_centroids.empty ())
+        {
+            m_min = std::numeric_limits<double>::infinity ();
+            m_max = -std::numeric_limits<double>::infinity ();
+        }
+    }
+
+private:
+    double K (double q) const
+    {
+        return m_compression / (2.0 * M_PI) * std::asin (2.0 * q - 1.0);
+    }
+
+    double KInverse (double k) const
+    {
+        if (k >= m_compression / 4.0)
+        {
+            return 1.0;
+        }
+        return (std::sin (2.0 * M_PI * k / m_compression) + 1.0) / 2.0;
+    }
+
+    double m_compression;
+    double m_total = 0.0;
+    double m_min = std::numeric_limits<double>::infinity ();
+    double m_max = -std::numeric_limits<double>::infinity ();
+    std::vector<Centroid> m_centroids;
+    std::vector<Centroid> m_buffer;
+};
+
+// Jain's fairness index (sum x)^2 / (n * sum x^2) over one run's per-client values
+class JainIndex
+{
+public:
+    void Add (double x)
+    {
+        m_n++;
+        m_sum += x;
+        m_sumSquares += x * x;
+    }
+
+    double Get () const
+    {
+        return m_sumSquares > 0 ? m_sum * m_sum / (m_n * m_sumSquares) : 1.0;
+    }
+
+private:
+    uint64_t m_n = 0;
+    double m_sum = 0.0;
+    double m_sumSquares = 0.0;
+};
+
+// Rate-control counters of one direction (RateTelemetry), summed over the
+// clients and runs of a summary. Every field is a count, so they merge by
+// adding. Slots 0..31 are MCS, the last one non-HT.
+struct RateCounters
+{
+    static constexpr std::size_t kSlots = 33;
+
+    std::array<uint64_t, kSlots> frames {}; // first attempts
+    std::array<uint64_t, kSlots> airtimeNs {};
+    std::array<uint64_t, kSlots> bestIntervals {};
+    uint64_t normal = 0;
+    uint64_t sampling = 0;
+    uint64_t retries = 0;
+    uint64_t intervals = 0;
+    uint64_t changes = 0;
+
+    static std::string SlotName (std::size_t slot)
+    {
+        return slot == kSlots - 1 ? "nonHt" : std::to_string (slot);
+    }
+
+    void Merge (const RateCounters &other)
+    {
+        for (std::size_t slot = 0; slot < kSlots; ++slot)
+        {
+            frames[slot] += other.frames[slot];
+            airtimeNs[slot] += other.airtimeNs[slot];
+            bestIntervals[slot] += other.bestIntervals[slot];
+        }
+        normal += other.normal;
+        sampling += other.sampling;
+        retries += other.retries;
+        intervals += other.intervals;
+        changes += other.changes;
+    }
+
+    // Same figures as RateTelemetry's per-client line
+    void Print (std::ostream &os) const
+    {
+        uint64_t first = normal + sampling;
+        std::size_t top = std::max_element (bestIntervals.begin (), bestIntervals.end ()) - bestIntervals.begin ();
+        os << " frames " << first
+           << " sampling " << (first ? 100.0 * sampling / first : 0.0) << " %"
+           << " retries " << (first ? 100.0 * retries / (first + retries) : 0.0) << " %"
+           << " changes/interval " << (intervals ? double (changes) / intervals : 0.0)
+           << " top " << SlotName (top)
+           << " residency " << (intervals ? 100.0 * bestIntervals[top] / intervals : 0.0) << " %";
+    }
+
+    // A totals line, then one line per slot used
+    void Write (std::ostream &os, const std::string &direction) const
+    {
+        os << "rate " << direction << " " << normal << " " << sampling << " " << retries << " " << intervals
+           << " " << changes << "\n";
+        for (std::size_t slot = 0; slot < kSlots; ++slot)
+        {
+            if (frames[slot] || airtimeNs[slot] || bestIntervals[slot])
+            {
+                os << "rateMcs " << direction << " " << slot << " " << frames[slot] << " " << airtimeNs[slot]
+                   << " " << bestIntervals[slot] << "\n";
+            }
+        }
+    }
+
+    void ReadTotals (std::istream &is)
+    {
+        uint64_t values[5] = {};
+        is >> values[0] >> values[1] >> values[2] >> values[3] >> values[4];
+        normal += values[0];
+        sampling += values[1];
+        retries += values[2];
+        intervals += values[3];
+        changes += values[4];
+    }
+
+    void ReadSlot (std::istream &is)
+    {
+        std::size_t slot = 0;
+        uint64_t values[3] = {};
+        is >> slot >> values[0] >> values[1] >> values[2];
+        if (slot < kSlots)
+        {
+            frames[slot] += values[0];
+            airtimeNs[slot] += values[1];
+            bestIntervals[slot] += values[2];
+        }
+    }
+};
+
+// Everything the scenario reports about completion times, kept as mergeable
+// summaries: completion times (Welford + t-digest, clients that never finish
+// censored at the end of their run and counted as incomplete), per-client
+// throughput, the Jain index of each run and, with --rateTelemetry, the
+// rate-control counters per direction. Saving to a file that already holds
+// a summary merges into it, so a sweep over seeds accumulates in one place.
+class CompletionSummary
+{
+public:
+    void AddCompletion (double seconds)
+    {
+        m_completion.Add (seconds);
+        m_digest.Add (seconds);
+    }
+
+    // A client still downloading when the run ends is counted at the end of
+    // the run (censored there), so the mean and quantiles are not those of
+    // only the clients fast enough to finish
+    void AddIncomplete (double stopSeconds)
+    {
+        AddCompletion (stopSeconds);
+        m_incomplete++;
+    }
+
+    void AddThroughput (double bitsPerSecond)
+    {
+        m_throughput.Add (bitsPerSecond);
+        m_runJain.Add (bitsPerSecond);
+    }
+
+    // Closes the current run: its Jain index becomes one sample across runs
+    void EndRun ()
+    {
+        m_jain.Add (m_runJain.Get ());
+        m_runJain = JainIndex ();
+    }
+
+    void Merge (const CompletionSummary &other)
+    {
+        m_completion.Merge (other.m_completion);
+        m_throughput.Merge (other.m_throughput);
+        m_jain.Merge (other.m_jain);
+        m_digest.Merge (other.m_digest);
+        m_incomplete += other.m_incomplete;
+        m_rates[0].Merge (other.m_rates[0]);
+        m_rates[1].Merge (other.m_rates[1]);
+    }
+
+    double Quantile (double q) { return m_digest.Quantile (q); }
+    const RunningStats &GetCompletion () const { return m_completion; }
+    const RunningStats &GetThroughput () const { return m_throughput; }
+    const RunningStats &GetJain () const { return m_jain; }
+    uint64_t GetIncomplete () const { return m_incomplete; }
+
+    // 0 for the AP towards the clients (down), 1 for the clients towards the AP (up)
+    RateCounters &GetRates (std::size_t direction) { return m_rates[direction]; }
+
+    void Print (std::ostream &os)
+    {
+        os << "Summary runs " << m_jain.GetCount ()
+           << " completed " << m_completion.GetCount () - m_incomplete
+           << " incomplete " << m_incomplete
+           << " mean " << m_completion.GetMean ()
+           << " stddev " << m_completion.GetStddev ()
+           << " p50 " << Quantile (0.50)
+           << " p90 " << Quantile (0.90)
+           << " p95 " << Quantile (0.95)
+           << " p99 " << Quantile (0.99)
+           << " max " << m_completion.GetMax ()
+           << " jain " << m_jain.GetMean () << std::endl;
+        for (std::size_t d = 0; d < 2; ++d)
+        {
+            if (m_rates[d].normal + m_rates[d].sampling > 0)
+            {
+                os << "Summary rate " << kDirections[d];
+                m_rates[d].Print (os);
+                os << std::endl;
+            }
+        }
+    }
+
+    bool Load (const std::string &fileName)
+    {
+        std::ifstream in (fileName);
+        if (!in)
+        {
+            return false;
+        }
+
+        std::string tag;
+        while (in >> tag)
+        {
+            if (tag == "completion") m_completion.Read (in);
+            else if (tag == "throughput") m_throughput.Read (in);
+            else if (tag == "jain") m_jain.Read (in);
+            else if (tag == "digest") m_digest.Read (in);
+            else if (tag == "incomplete") in >> m_incomplete;
+            else if (tag == "rate" || tag == "rateMcs")
+            {
+                std::string direction;
+                in >> direction;
+                RateCounters &rates = m_rates[direction == kDirections[1]];
+                if (tag == "rate")
+                {
+                    rates.ReadTotals (in);
+                }
+                else
+                {
+                    rates.ReadSlot (in);
+                }
+            }
+            else std::getline (in, tag);
+        }
+        return true;
+    }
+
+    // Merges with whatever summary the file already holds, then rewrites it
+    void Save (const std::string &fileName)
+    {
+        CompletionSummary merged;
+        merged.Load (fileName);
+        merged.Merge (*this);
+
+        std::ofstream out (fileName);
+        out.precision (17);
+        out << "# completion-summary v1\n";
+        out << "completion ";
+        merged.m_completion.Write (out);
+        out << "\nthroughput ";
+        merged.m_throughput.Write (out);
+        out << "\njain ";
+        merged.m_jain.Write (out);
+        out << "\nincomplete " << merged.m_incomplete << "\n";
+        for (std::size_t d = 0; d < 2; ++d)
+        {
+            if (merged.m_rates[d].normal + merged.m_rates[d].sampling + merged.m_rates[d].retries > 0)
+            {
+                merged.m_rates[d].Write (out, kDirections[d]);
+            }
+        }
+        merged.m_digest.Write (out);
+    }
+
+    void WriteEcdf (const std::string &fileName)
+    {
+        std::ofstream out (fileName);
+        out << "# completionSeconds\tfraction\n";
+        for (const auto &point : m_digest.Ecdf ())
+        {
+            out << point.first << "\t" << point.second << "\n";
+        }
+    }
+
+private:
+    static constexpr const char *kDirections[2] = {"down", "up"};
+
+    RunningStats m_completion;
+    RunningStats m_throughput;
+    RunningStats m_jain;
+    JainIndex m_runJain;
+    QuantileDigest m_digest;
+    uint64_t m_incomplete = 0;
+    RateCounters m_rates[2];
+};
+
+#endif // STREAMING_STATS_H
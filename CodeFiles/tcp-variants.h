@@ -0,0 +1,144 @@
+#ifndef TCP_VARIANTS_H
+#define TCP_VARIANTS_H
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/applications-module.h"
+
+#include "scenario-log.h"
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace ns3;
+
+// Per-download TCP bookkeeping, filled in by the socket trace sinks below
+struct TcpFlowTrace
+{
+    std::string variant;
+    uint32_t retransmissions = 0;
+    SequenceNumber32 highestTxSeq = SequenceNumber32 (0);
+};
+
+// Accepts "Cubic", "TcpCubic" or "ns3::TcpCubic" and returns the full TypeId name
+inline std::string NormalizeTcpVariant (std::string name)
+{
+    if (name.rfind ("ns3::", 0) == 0)
+    {
+        name = name.substr (5);
+    }
+    if (name.rfind ("Tcp", 0) != 0)
+    {
+        name = "Tcp" + name;
+    }
+    return "ns3::" + name;
+}
+
+// Splits a comma-separated list such as "Cubic,Bbr,WestwoodPlus,Vegas"
+inline std::vector<std::string> ParseTcpVariants (const std::string &list)
+{
+    std::vector<std::string> variants;
+    std::istringstream is (list);
+    std::string item;
+
+    while (std::getline (is, item, ','))
+    {
+        if (item.empty ())
+        {
+            continue;
+        }
+        std::string name = NormalizeTcpVariant (item);
+        TypeId tid;
+        if (!TypeId::LookupByNameFailSafe (name, &tid))
+        {
+            NS_FATAL_ERROR ("Unknown TCP congestion control variant " << item);
+        }
+        variants.push_back (name);
+    }
+
+    if (variants.empty ())
+    {
+        variants.push_back ("ns3::TcpNewReno");
+    }
+    return variants;
+}
+
+// Must run before the internet stack is installed. A single variant becomes
+// the default for every socket; with several, sockets are switched one by one
+// in AttachTcpFlow.
+inline void ConfigureTcpVariants (const std::vector<std::string> &variants)
+{
+    if (variants.size () == 1)
+    {
+        Config::SetDefault ("ns3::TcpL4Protocol::SocketType",
+                            TypeIdValue (TypeId::LookupByName (variants[0])));
+    }
+
+    for (const auto &variant : variants)
+    {
+        if (variant == "ns3::TcpBbr")
+        {
+            // BBR relies on pacing
+            Config::SetDefault ("ns3::TcpSocketState::EnablePacing", BooleanValue (true));
+        }
+    }
+}
+
+inline void CwndChange (Ptr<OutputStreamWrapper> stream, uint32_t clientId,
+                        uint32_t oldCwnd, uint32_t newCwnd)
+{
+    *stream->GetStream () << Simulator::Now ().GetSeconds () << "\t" << clientId
+                          << "\t" << oldCwnd << "\t" << newCwnd << std::endl;
+}
+
+// A data segment that starts below the highest sequence already sent is a retransmission
+inline void TcpTx (TcpFlowTrace *flow, Ptr<const Packet> packet, const TcpHeader &header,
+                   Ptr<const TcpSocketBase> socket)
+{
+    if (packet->GetSize () == 0)
+    {
+        return;
+    }
+
+    SequenceNumber32 end = header.GetSequenceNumber () + packet->GetSize ();
+    if (header.GetSequenceNumber () < flow->highestTxSeq)
+    {
+        flow->retransmissions++;
+        SCENARIO_LOG (Debug, Tcp, "retransmission seq %u size %u", header.GetSequenceNumber ().GetValue (), packet->GetSize ());
+    }
+    if (end > flow->highestTxSeq)
+    {
+        flow->highestTxSeq = end;
+    }
+}
+
+// Scheduled just after the BulkSendApplication has opened its socket: sets the
+// client's congestion control (when more than one variant is in use) and hooks
+// the cwnd and retransmission traces.
+inline void AttachTcpFlow (Ptr<BulkSendApplication> app, TcpFlowTrace *flow, bool perSocket,
+                           uint32_t clientId, Ptr<OutputStreamWrapper> cwndStream)
+{
+    Ptr<TcpSocketBase> socket = DynamicCast<TcpSocketBase> (app->GetSocket ());
+    if (!socket)
+    {
+        NS_FATAL_ERROR ("Client " << clientId << " download has no TCP socket yet");
+    }
+
+    if (perSocket)
+    {
+        ObjectFactory factory;
+        factory.SetTypeId (flow->variant);
+        socket->SetCongestionControlAlgorithm (factory.Create<TcpCongestionOps> ());
+    }
+
+    socket->TraceConnectWithoutContext ("Tx", MakeBoundCallback (&TcpTx, flow));
+    if (cwndStream)
+    {
+        socket->TraceConnectWithoutContext ("CongestionWindow",
+                                            MakeBoundCallback (&CwndChange, cwndStream, clientId));
+    }
+}
+
+#endif // TCP_VARIANTS_H
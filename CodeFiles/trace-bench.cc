@@ -0,0 +1,132 @@
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/wifi-module.h"
+#include "ns3/applications-module.h"
+
+#include "bulk-trace.h"
+
+#include <chrono>
+#include <iostream>
+#include <string>
+
+using namespace ns3;
+
+// Startup cost of hooking a trace source on every node, the ways the
+// scenarios and tools have done it and with BulkTraceConnect:
+//   ./ns3 run "scratch/trace-bench --nodes=10000"
+// Every method connects the same sources on the same objects, after an
+// unreported pass of all of them; nothing is run.
+
+uint64_t g_calls = 0;
+
+void SinkRx (Ptr<const Packet> packet, const Address &from)
+{
+    g_calls++;
+}
+
+void SinkRxContext (std::string context, Ptr<const Packet> packet, const Address &from)
+{
+    g_calls++;
+}
+
+void SinkRxIndex (uint32_t index, Ptr<const Packet> packet, const Address &from)
+{
+    g_calls++;
+}
+
+void PhyRxEnd (Ptr<const Packet> packet)
+{
+    g_calls++;
+}
+
+void PhyRxEndIndex (uint32_t index, Ptr<const Packet> packet)
+{
+    g_calls++;
+}
+
+// The first pass warms TypeId, Config and trace source lookups and is not
+// reported, so no method pays them for the ones after it
+template <typename F>
+void Measure (bool report, const std::string &label, uint32_t objects, F connect)
+{
+    auto start = std::chrono::steady_clock::now ();
+    connect ();
+    double seconds = std::chrono::duration<double> (std::chrono::steady_clock::now () - start).count ();
+    if (report)
+    {
+        std::cout << label << " " << seconds * 1e3 << " ms, " << seconds * 1e6 / objects << " us/object" << std::endl;
+    }
+}
+
+int main (int argc, char *argv[])
+{
+    uint32_t nodes = 10000;
+    bool wifi = true;
+
+    CommandLine cmd;
+    cmd.AddValue ("nodes", "Nodes, each with a PacketSink and (with wifi) a Wi-Fi device", nodes);
+    cmd.AddValue ("wifi", "Also measure a PHY trace source on Wi-Fi devices", wifi);
+    cmd.Parse (argc, argv);
+
+    NodeContainer allNodes;
+    allNodes.Create (nodes);
+    PacketSinkHelper sinkHelper ("ns3::TcpSocketFactory", InetSocketAddress (Ipv4Address::GetAny (), 9));
+    ApplicationContainer sinks = sinkHelper.Install (allNodes);
+
+    NetDeviceContainer devices;
+    if (wifi)
+    {
+        YansWifiChannelHelper channel = YansWifiChannelHelper::Default ();
+        YansWifiPhyHelper phy;
+        phy.SetChannel (channel.Create ());
+        WifiMacHelper mac;
+        mac.SetType ("ns3::AdhocWifiMac");
+        WifiHelper wifiHelper;
+        wifiHelper.SetStandard (WIFI_STANDARD_80211n);
+        devices = wifiHelper.Install (phy, mac, allNodes);
+    }
+    auto selectPhy = [] (Ptr<NetDevice> device) { return DynamicCast<WifiNetDevice> (device)->GetPhy (); };
+
+    for (bool report : {false, true})
+    {
+        Measure (report, "sinks: Config wildcard path          ", nodes, [&] () {
+            Config::ConnectWithoutContext ("/NodeList/*/ApplicationList/*/$ns3::PacketSink/Rx", MakeCallback (&SinkRx));
+        });
+        Measure (report, "sinks: Config path per node          ", nodes, [&] () {
+            for (uint32_t i = 0; i < nodes; ++i)
+            {
+                Config::Connect ("/NodeList/" + std::to_string (i) + "/ApplicationList/0/$ns3::PacketSink/Rx",
+                                 MakeCallback (&SinkRxContext));
+            }
+        });
+        Measure (report, "sinks: TraceConnect per application  ", nodes, [&] () {
+            for (uint32_t i = 0; i < sinks.GetN (); ++i)
+            {
+                sinks.Get (i)->TraceConnectWithoutContext ("Rx", MakeCallback (&SinkRx));
+            }
+        });
+        Measure (report, "sinks: BulkTraceConnect              ", nodes, [&] () {
+            BulkTraceConnect (sinks, "Rx", MakeCallback (&SinkRxIndex));
+        });
+
+        if (wifi)
+        {
+            Measure (report, "phys:  Config wildcard path          ", nodes, [&] () {
+                Config::ConnectWithoutContext ("/NodeList/*/DeviceList/*/$ns3::WifiNetDevice/Phy/PhyRxEnd",
+                                               MakeCallback (&PhyRxEnd));
+            });
+            Measure (report, "phys:  TraceConnect per device       ", nodes, [&] () {
+                for (uint32_t i = 0; i < devices.GetN (); ++i)
+                {
+                    selectPhy (devices.Get (i))->TraceConnectWithoutContext ("PhyRxEnd", MakeCallback (&PhyRxEnd));
+                }
+            });
+            Measure (report, "phys:  BulkTraceConnect              ", nodes, [&] () {
+                BulkTraceConnect (devices, "PhyRxEnd", MakeCallback (&PhyRxEndIndex), selectPhy);
+            });
+        }
+    }
+
+    Simulator::Destroy ();
+    return 0;
+}
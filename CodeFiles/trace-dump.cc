@@ -0,0 +1,147 @@
+#include "ns3/core-module.h"
+
+#include "binary-trace.h"
+
+#include <cstdio>
+#include <iostream>
+#include <map>
+#include <string>
+
+using namespace ns3;
+
+// Reads a binary event trace written by BinaryTraceWriter and prints it as
+// text (one line per event, like the old ASCII traces) or converts it to CSV:
+//   ./ns3 run "scratch/trace-dump --input=d-events.btr"
+//   ./ns3 run "scratch/trace-dump --input=d-events.btr --format=csv --output=d-events.csv"
+//   ./ns3 run "scratch/trace-dump --input=d-events.btr --event=Completion"
+
+std::string FormatAddress (uint32_t address)
+{
+    return std::to_string (address >> 24) + "." + std::to_string ((address >> 16) & 0xff) + "."
+           + std::to_string ((address >> 8) & 0xff) + "." + std::to_string (address & 0xff);
+}
+
+int main (int argc, char *argv[])
+{
+    std::string input = "";
+    std::string output = "";
+    std::string format = "text";
+    std::string event = "";
+    int64_t node = -1;
+    bool summary = false;
+
+    CommandLine cmd;
+    cmd.AddValue ("input", "Binary trace file", input);
+    cmd.AddValue ("output", "Output file (empty for stdout)", output);
+    cmd.AddValue ("format", "text or csv", format);
+    cmd.AddValue ("event", "Only this event type (Rx, Tx, Drop, Completion)", event);
+    cmd.AddValue ("node", "Only this node (-1 for all)", node);
+    cmd.AddValue ("summary", "Print event counts and bytes per type and node instead of the events", summary);
+    cmd.Parse (argc, argv);
+
+    std::FILE *in = std::fopen (input.c_str (), "rb");
+    if (!in)
+    {
+        NS_FATAL_ERROR ("Cannot open " << input);
+    }
+    TraceFileHeader header;
+    if (std::fread (&header, sizeof (header), 1, in) != 1 || std::string (header.magic) != "NS3BTRC"
+        || header.recordSize != sizeof (TraceRecord))
+    {
+        NS_FATAL_ERROR (input << " is not a binary trace of this version");
+    }
+
+    std::FILE *out = output.empty () ? stdout : std::fopen (output.c_str (), "w");
+    if (!out)
+    {
+        NS_FATAL_ERROR ("Cannot open " << output);
+    }
+    if (format == "csv" && !summary)
+    {
+        std::fprintf (out, "time,node,device,event,size,flow,context,aux\n");
+    }
+
+    std::map<uint32_t, std::string> strings;
+    std::map<std::pair<std::string, uint32_t>, std::pair<uint64_t, uint64_t>> counts;
+    TraceRecord buffer[2048];
+    std::size_t n;
+    std::string pending;
+    uint32_t pendingId = 0;
+    std::size_t pendingLength = 0;
+
+    while ((n = std::fread (buffer, sizeof (TraceRecord), 2048, in)) > 0)
+    {
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            const TraceRecord &r = buffer[i];
+
+            // Bytes of a context path being defined
+            if (pending.size () < pendingLength)
+            {
+                pending.append (reinterpret_cast<const char *> (&r),
+                                std::min (sizeof (TraceRecord), pendingLength - pending.size ()));
+                if (pending.size () == pendingLength)
+                {
+                    strings[pendingId] = pending;
+                }
+                continue;
+            }
+            if (r.event == static_cast<uint8_t> (TraceEvent::StringDef))
+            {
+                pending.clear ();
+                pendingId = r.context;
+                pendingLength = r.size;
+                if (pendingLength == 0)
+                {
+                    strings[pendingId] = "";
+                }
+                continue;
+            }
+
+            const char *name = TraceEventName (r.event);
+            if ((!event.empty () && event != name) || (node >= 0 && r.node != node))
+            {
+                continue;
+            }
+            if (summary)
+            {
+                auto &count = counts[{name, r.node}];
+                count.first++;
+                count.second += r.size;
+                continue;
+            }
+
+            double seconds = r.timeNs * 1e-9;
+            std::string flow = r.event == static_cast<uint8_t> (TraceEvent::Rx) ? FormatAddress (r.flow)
+                                                                                 : std::to_string (r.flow);
+            const std::string &context = strings[r.context];
+            if (format == "csv")
+            {
+                std::fprintf (out, "%.9f,%u,%u,%s,%u,%s,%s,%u\n", seconds, r.node, r.device, name, r.size,
+                              flow.c_str (), context.c_str (), r.aux);
+            }
+            else
+            {
+                std::fprintf (out, "%.9f %s node %u dev %u size %u flow %s aux %u %s\n", seconds, name, r.node,
+                              r.device, r.size, flow.c_str (), r.aux, context.c_str ());
+            }
+        }
+    }
+
+    if (summary)
+    {
+        std::fprintf (out, "%-12s %6s %12s %14s\n", "event", "node", "count", "bytes");
+        for (const auto &entry : counts)
+        {
+            std::fprintf (out, "%-12s %6u %12lu %14lu\n", entry.first.first.c_str (), entry.first.second,
+                          static_cast<unsigned long> (entry.second.first), static_cast<unsigned long> (entry.second.second));
+        }
+    }
+
+    std::fclose (in);
+    if (out != stdout)
+    {
+        std::fclose (out);
+    }
+    return 0;
+}
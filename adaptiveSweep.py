@@ -0,0 +1,273 @@
+import argparse
+import os
+import random
+import re
+import subprocess
+import sys
+
+# Finds the client count at which completion time blows up, without running
+# every numClients value. Coarse points are run first, then the search bisects
+# towards either an SLA threshold or the knee of the completion-time curve.
+# Confidence bounds come from bootstrapping the runs at each point.
+#
+# Run from the ns-3 root directory, e.g.
+#   python3 adaptiveSweep.py --part d --metric p95 --sla 15
+#   python3 adaptiveSweep.py --part e --metric p50 --runs 3 --max 60
+#   python3 adaptiveSweep.py --part d --sla 15 --cacheDir sweepCache -- --airtimeFairness=1
+
+completion_pattern = re.compile(r'Client (\d+) completed at time ([\d.]+) seconds')
+
+
+def quantile(values, q):
+    ordered = sorted(values)
+    position = q * (len(ordered) - 1)
+    below = int(position)
+    above = min(below + 1, len(ordered) - 1)
+    return ordered[below] + (position - below) * (ordered[above] - ordered[below])
+
+
+def metric_quantile(metric):
+    if metric == 'mean':
+        return None
+    return float(metric[1:]) / 100.0
+
+
+class Sweep:
+    def __init__(self, options):
+        self.options = options
+        self.q = metric_quantile(options.metric)
+        self.samples = {}   # numClients -> one list of completion times per run
+        self.simulations = 0
+        self.rng = random.Random(options.seed)
+
+    def run(self, num_clients, rng_run):
+        stem = os.path.join(self.options.outDir, '{}-n{}-run{}'.format(self.options.part, num_clients, rng_run))
+        args = ['--numClients={}'.format(num_clients), '--RngRun={}'.format(rng_run)] + self.options.args
+        if self.options.cacheDir:
+            args.append('--cacheDir={}'.format(self.options.cacheDir))
+        command = [self.options.ns3, 'run', 'scratch/{} {}'.format(self.options.part, ' '.join(args))]
+        print('Running numClients={} run {}'.format(num_clients, rng_run), file=sys.stderr)
+        result = subprocess.run(command, stdout=subprocess.PIPE, stderr=subprocess.STDOUT, text=True)
+        with open(stem + '.txt', 'w') as f:
+            f.write(result.stdout)
+        if result.returncode != 0:
+            sys.exit('Run failed ({}), see {}.txt'.format(' '.join(command), stem))
+        self.simulations += 1
+
+        # Clients still downloading at the end are censored at the horizon
+        times = [self.options.horizon] * num_clients
+        for match in completion_pattern.finditer(result.stdout):
+            client = int(match.group(1))
+            if client < num_clients:
+                times[client] = float(match.group(2))
+        return times
+
+    def evaluate(self, num_clients, runs=None):
+        runs = runs or self.options.runs
+        per_run = self.samples.setdefault(num_clients, [])
+        while len(per_run) < runs:
+            per_run.append(self.run(num_clients, len(per_run) + 1))
+        return self.estimate(per_run)
+
+    def estimate(self, per_run):
+        pooled = [t for times in per_run for t in times]
+        if self.q is None:
+            return sum(pooled) / len(pooled)
+        return quantile(pooled, self.q)
+
+    def resample(self, per_run):
+        # Whole runs when there are several, otherwise clients within the run
+        if len(per_run) > 1:
+            return [self.rng.choice(per_run) for _ in per_run]
+        return [[self.rng.choice(per_run[0]) for _ in per_run[0]]]
+
+    def interval(self, num_clients):
+        per_run = self.samples[num_clients]
+        estimates = sorted(self.estimate(self.resample(per_run)) for _ in range(self.options.bootstrap))
+        tail = (1.0 - self.options.confidence) / 2
+        return quantile(estimates, tail), quantile(estimates, 1.0 - tail)
+
+    def points(self):
+        return sorted((n, self.estimate(per_run)) for n, per_run in self.samples.items())
+
+    def report(self):
+        print('{:>10} {:>6} {:>12} {:>22}'.format('numClients', 'runs', self.options.metric + ' (s)',
+                                                   '{:.0%} interval (s)'.format(self.options.confidence)))
+        for n, value in self.points():
+            low, high = self.interval(n)
+            print('{:>10} {:>6} {:>12.3f} {:>10.3f} .. {:<9.3f}'.format(n, len(self.samples[n]), value, low, high))
+
+
+def coarse_grid(options):
+    span = options.max - options.min
+    count = max(2, min(options.coarse, span + 1))
+    return sorted({options.min + round(i * span / (count - 1)) for i in range(count)})
+
+
+def search_sla(sweep, options):
+    grid = coarse_grid(options)
+    meets = {n: sweep.evaluate(n) < options.sla for n in grid}
+    if not meets[grid[0]]:
+        return None, 'numClients={} already misses the SLA'.format(grid[0])
+    if all(meets.values()):
+        return grid[-1], 'SLA met up to numClients={}, the top of the range'.format(grid[-1])
+
+    # First crossing on the coarse grid, then bisect it
+    low = max(n for n in grid if meets[n] and all(meets[m] for m in grid if m < n))
+    high = min(n for n in grid if n > low)
+    while high - low > 1:
+        mid = (low + high) // 2
+        value = sweep.evaluate(mid)
+        ci_low, ci_high = sweep.interval(mid)
+        # Ambiguous point: add replications before deciding which way to go
+        while ci_low < options.sla <= ci_high and len(sweep.samples[mid]) < options.maxRuns:
+            value = sweep.evaluate(mid, len(sweep.samples[mid]) + 1)
+            ci_low, ci_high = sweep.interval(mid)
+        if value < options.sla:
+            low = mid
+        else:
+            high = mid
+    return low, None
+
+
+def sla_bounds(sweep, options, answer):
+    # Largest point that meets the SLA with confidence, smallest that misses it with confidence
+    confident_low, confident_high = None, None
+    for n, _ in sweep.points():
+        ci_low, ci_high = sweep.interval(n)
+        if n <= answer and ci_high < options.sla:
+            confident_low = n
+        if n > answer and ci_low >= options.sla and confident_high is None:
+            confident_high = n - 1
+    return confident_low, confident_high
+
+
+def solve(matrix, vector):
+    # Gaussian elimination with partial pivoting; None if singular
+    size = len(vector)
+    rows = [row[:] + [value] for row, value in zip(matrix, vector)]
+    for col in range(size):
+        pivot = max(range(col, size), key=lambda r: abs(rows[r][col]))
+        if abs(rows[pivot][col]) < 1e-12:
+            return None
+        rows[col], rows[pivot] = rows[pivot], rows[col]
+        for r in range(size):
+            if r != col:
+                factor = rows[r][col] / rows[col][col]
+                rows[r] = [a - factor * b for a, b in zip(rows[r], rows[col])]
+    return [rows[i][size] / rows[i][i] for i in range(size)]
+
+
+def fit_knee(points, horizon):
+    # Continuous two-segment fit y = a + b x + c max(0, x - k); the k with the
+    # smallest squared error, over every integer strictly inside the range.
+    # Points pinned at the horizon flatten the curve, so they are left out.
+    uncensored = [(x, y) for x, y in points if y < horizon]
+    if len(uncensored) >= 4:
+        points = uncensored
+    xs = [x for x, _ in points]
+    best = None
+    for k in range(min(xs) + 1, max(xs)):
+        basis = [(1.0, x, max(0.0, x - k)) for x in xs]
+        matrix = [[sum(b[i] * b[j] for b in basis) for j in range(3)] for i in range(3)]
+        vector = [sum(b[i] * y for b, (_, y) in zip(basis, points)) for i in range(3)]
+        coeffs = solve(matrix, vector)
+        if coeffs is None:
+            continue
+        error = sum((y - sum(c * v for c, v in zip(coeffs, b))) ** 2 for b, (_, y) in zip(basis, points))
+        if best is None or error < best[0]:
+            best = (error, k)
+    return best[1] if best else None
+
+
+def search_knee(sweep, options):
+    for n in coarse_grid(options):
+        sweep.evaluate(n)
+
+    while sweep.simulations < options.budget:
+        knee = fit_knee(sweep.points(), options.horizon)
+        if knee is None:
+            break
+        # Split the widest gap next to the knee until it is resolved
+        xs = [n for n, _ in sweep.points()]
+        left = max(n for n in xs if n <= knee)
+        right = min(n for n in xs if n > knee)
+        gaps = [(right - left, left, right)]
+        if left > xs[0]:
+            gaps.append((left - max(n for n in xs if n < left), max(n for n in xs if n < left), left))
+        if right < xs[-1]:
+            gaps.append((min(n for n in xs if n > right) - right, right, min(n for n in xs if n > right)))
+        width, a, b = max(gaps)
+        if width <= options.resolution:
+            break
+        sweep.evaluate((a + b) // 2)
+
+    knee = fit_knee(sweep.points(), options.horizon)
+    estimates = []
+    for _ in range(options.bootstrap):
+        points = [(n, sweep.estimate(sweep.resample(per_run))) for n, per_run in sorted(sweep.samples.items())]
+        estimate = fit_knee(points, options.horizon)
+        if estimate is not None:
+            estimates.append(estimate)
+    tail = (1.0 - options.confidence) / 2
+    bounds = (quantile(estimates, tail), quantile(estimates, 1.0 - tail)) if estimates else (None, None)
+    return knee, bounds
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Adaptive numClients sweep for the saturation knee or an SLA')
+    parser.add_argument('--ns3', default='./ns3', help='Path to the ns3 driver script')
+    parser.add_argument('--part', default='d', help='Scenario to run (a, b, c, d or e)')
+    parser.add_argument('--metric', default='p95', help='mean, or a percentile such as p50 or p95')
+    parser.add_argument('--sla', type=float, help='Find the largest numClients with metric below this many seconds '
+                                                  '(without it, locate the knee of the curve)')
+    parser.add_argument('--min', type=int, default=1, help='Smallest numClients considered')
+    parser.add_argument('--max', type=int, default=50, help='Largest numClients considered')
+    parser.add_argument('--coarse', type=int, default=5, help='Points in the initial coarse grid')
+    parser.add_argument('--runs', type=int, default=1, help='RngRun replications per point')
+    parser.add_argument('--maxRuns', type=int, default=5, help='Replications allowed at a point whose interval straddles the SLA')
+    parser.add_argument('--budget', type=int, default=20, help='Maximum simulations for the knee search')
+    parser.add_argument('--resolution', type=int, default=1, help='Stop once the knee is bracketed this tightly')
+    parser.add_argument('--horizon', type=float, default=20.0, help='Simulation end, used for clients that never complete')
+    parser.add_argument('--confidence', type=float, default=0.9)
+    parser.add_argument('--bootstrap', type=int, default=500, help='Bootstrap resamples for the intervals')
+    parser.add_argument('--seed', type=int, default=1, help='Seed of the bootstrap resampling')
+    parser.add_argument('--outDir', default='sweepRuns', help='Where run logs are written')
+    parser.add_argument('--cacheDir', help='Result cache passed to every run')
+    parser.add_argument('args', nargs='*', help='Extra scenario arguments, after --')
+    options = parser.parse_args()
+
+    if options.metric != 'mean' and not re.fullmatch(r'p\d+(\.\d+)?', options.metric):
+        parser.error('--metric must be mean or pNN')
+    os.makedirs(options.outDir, exist_ok=True)
+    sweep = Sweep(options)
+    grid_cost = (options.max - options.min + 1) * options.runs
+
+    if options.sla is not None:
+        answer, note = search_sla(sweep, options)
+        sweep.report()
+        print()
+        if note:
+            print(note)
+        if answer is not None and not note:
+            low, high = sla_bounds(sweep, options, answer)
+            print('Largest numClients with {} < {} s: {} ({:.0%} bounds {} .. {})'.format(
+                options.metric, options.sla, answer, options.confidence,
+                low if low is not None else '<{}'.format(options.min), high if high is not None else '?'))
+    else:
+        knee, (low, high) = search_knee(sweep, options)
+        sweep.report()
+        print()
+        if knee is None:
+            print('Not enough points to fit a knee')
+        else:
+            # Bounds are unknown when every bootstrap fit failed
+            print('Knee of {} completion time at numClients {} ({:.0%} bounds {} .. {})'.format(
+                options.metric, knee, options.confidence,
+                '{:.0f}'.format(low) if low is not None else '?', '{:.0f}'.format(high) if high is not None else '?'))
+
+    print('{} simulations (full grid: {})'.format(sweep.simulations, grid_cost))
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,210 @@
+import argparse
+import os
+import re
+import statistics
+import subprocess
+import sys
+
+# Runs one scenario under several variants on identical random streams (same
+# RngSeed/RngRun for every variant, and the scenarios' fixed per-node streams)
+# and tabulates the results. Each variant is also compared against the first
+# one run by run, as paired differences with a confidence interval.
+#
+# Run from the ns-3 root directory, e.g.
+#   python3 compareVariants.py --part d --numClients 10 --runs 1 2 3
+#   python3 compareVariants.py --part e --tcpVariants Cubic Bbr
+#   python3 compareVariants.py --part d --variant "rts=--ns3::WifiRemoteStationManager::RtsCtsThreshold=0"
+#   python3 compareVariants.py --part d --tcpVariants --perClient \
+#       --variant "fifo=" --variant "airtime=--airtimeFairness=1"
+#   python3 compareVariants.py --tcpVariants --runs 1 2 3 4 5 --variant "d@d=" --variant "e@e="
+#   python3 compareVariants.py --part d --tcpVariants --variant minstrel= \
+#       --variant snr=--rateManager=ns3::SnrTableWifiManager \
+#       --variant mcs7="--rateManager=ns3::ConstantRateWifiManager --ns3::ConstantRateWifiManager::DataMode=HtMcs7"
+#   python3 compareVariants.py --part d --tcpVariants --runs 1 2 3 --variant yans=--phyTier=yans \
+#       --variant spectrum=--phyTier=spectrum
+
+completion_pattern = re.compile(r'Client (\d+) completed at time ([\d.]+) seconds')
+retransmission_pattern = re.compile(r'Client (\d+) tcp (\S+) retransmissions (\d+)')
+airtime_pattern = re.compile(r'Client (\d+) downlink airtime ([\d.e+-]+) s share ([\d.e+-]+) %')
+simulation_pattern = re.compile(r'Simulation: (\d+) events in ([\d.e+-]+) s wall, ([\d.e+-]+) events/s, mean throughput ([\d.e+-]+) Mbps')
+
+
+def run_scenario(ns3, part, args, log_path):
+    command = [ns3, 'run', 'scratch/{} {}'.format(part, ' '.join(args))]
+    result = subprocess.run(command, stdout=subprocess.PIPE, stderr=subprocess.STDOUT, text=True)
+    with open(log_path, 'w') as f:
+        f.write(result.stdout)
+    if result.returncode != 0:
+        sys.exit('Run failed ({}), see {}'.format(' '.join(command), log_path))
+    return result.stdout
+
+
+def parse_output(output):
+    completions = {}
+    retransmissions = {}
+    airtime_shares = {}
+    simulation = None
+    for line in output.splitlines():
+        match = completion_pattern.search(line)
+        if match:
+            completions[int(match.group(1))] = float(match.group(2))
+            continue
+        match = retransmission_pattern.search(line)
+        if match:
+            retransmissions[int(match.group(1))] = int(match.group(3))
+            continue
+        match = airtime_pattern.search(line)
+        if match:
+            airtime_shares[int(match.group(1))] = float(match.group(3))
+            continue
+        match = simulation_pattern.search(line)
+        if match:
+            simulation = (float(match.group(3)), float(match.group(4)), float(match.group(2)))
+    return completions, retransmissions, airtime_shares, simulation
+
+
+def print_per_client(rows, num_clients):
+    # Mean over runs of each client's completion time and airtime share, and the
+    # change in completion time relative to the first variant
+    baseline = rows[0]
+    print()
+    print('{:<8} {:<14} {:>10} {:>10} {:>12}'.format('client', 'variant', 'done (s)', 'change (s)', 'airtime (%)'))
+    for client in range(num_clients):
+        base_times = baseline[5].get(client, [])
+        base_mean = statistics.mean(base_times) if base_times else float('nan')
+        for label, _, _, _, _, per_client_times, per_client_airtime, _, _ in rows:
+            times = per_client_times.get(client, [])
+            shares = per_client_airtime.get(client, [])
+            mean = statistics.mean(times) if times else float('nan')
+            share = statistics.mean(shares) if shares else float('nan')
+            print('{:<8} {:<14} {:>10.2f} {:>+10.2f} {:>12.1f}'.format(client, label, mean, mean - base_mean, share))
+
+
+# Two-sided 95% Student t quantiles by degrees of freedom
+t_quantiles = [12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+               2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+               2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042]
+
+
+def run_mean(completions, num_clients, horizon):
+    # Mean completion time of one run, clients that never finish counted at the horizon
+    times = [completions.get(client, horizon) for client in range(num_clients)]
+    return statistics.mean(times)
+
+
+def print_paired(rows):
+    # Per-run differences against the first variant: with common random numbers
+    # most of the run-to-run noise cancels, so the interval is far tighter than
+    # comparing the two means independently
+    baseline = rows[0]
+    print()
+    print('{:<14} {:>6} {:>14} {:>24} {:>24}'.format(
+        'variant', 'pairs', 'diff mean (s)', 'paired 95% CI (s)', 'unpaired 95% CI (s)'))
+    for row in rows[1:]:
+        diffs = [b - a for a, b in zip(baseline[7], row[7])]
+        if len(diffs) < 2:
+            print('{:<14} {:>6} {:>14.3f} {:>24} {:>24}'.format(row[0], len(diffs),
+                                                                 diffs[0] if diffs else float('nan'), 'need 2+ runs', '-'))
+            continue
+        t = t_quantiles[len(diffs) - 2] if len(diffs) - 1 <= len(t_quantiles) else 1.96
+        mean = statistics.mean(diffs)
+        half = t * statistics.stdev(diffs) / len(diffs) ** 0.5
+        unpaired = t * (statistics.variance(baseline[7]) / len(baseline[7])
+                        + statistics.variance(row[7]) / len(row[7])) ** 0.5
+        print('{:<14} {:>6} {:>+14.3f} {:>+11.3f} .. {:<+9.3f} {:>+11.3f} .. {:<+9.3f}'.format(
+            row[0], len(diffs), mean, mean - half, mean + half, mean - unpaired, mean + unpaired))
+
+
+def build_variants(options):
+    # Variants are label=args, or label@part=args to run another scenario
+    variants = []
+    for tcp in options.tcpVariants:
+        variants.append((tcp, options.part, ['--tcpVariant=' + tcp]))
+    for spec in options.variant:
+        label, _, args = spec.partition('=')
+        label, _, part = label.partition('@')
+        variants.append((label, part or options.part, args.split()))
+    return variants
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Side-by-side comparison of scenario variants')
+    parser.add_argument('--ns3', default='./ns3', help='Path to the ns3 driver script')
+    parser.add_argument('--part', default='d', help='Scenario to run (a, b, c, d, e or f)')
+    parser.add_argument('--numClients', type=int, default=10)
+    parser.add_argument('--runs', type=int, nargs='+', default=[1], help='RngRun values, shared by all variants')
+    parser.add_argument('--tcpVariants', nargs='*', default=['NewReno', 'Cubic', 'Bbr', 'WestwoodPlus', 'Vegas'])
+    parser.add_argument('--variant', action='append', default=[],
+                        help='Extra variant as label=args or label@part=args, e.g. "rts=--ns3::WifiRemoteStationManager::RtsCtsThreshold=0"')
+    parser.add_argument('--outDir', default='variantRuns', help='Where run logs and cwnd traces are written')
+    parser.add_argument('--perClient', action='store_true',
+                        help='Also tabulate each client against the first variant, with its airtime share')
+    parser.add_argument('--horizon', type=float, default=20.0,
+                        help='Simulation end, used for clients that never complete in the paired comparison')
+    parser.add_argument('--cacheDir', help='Result cache shared by the runs, so unchanged variants are not simulated again')
+    options = parser.parse_args()
+
+    os.makedirs(options.outDir, exist_ok=True)
+    variants = build_variants(options)
+    rows = []
+
+    for label, part, variant_args in variants:
+        completion_times = []
+        retransmissions = []
+        incomplete = 0
+        cwnd_files = []
+        per_client_times = {}
+        per_client_airtime = {}
+        run_means = []
+        simulations = []
+
+        for run in options.runs:
+            stem = os.path.join(options.outDir, '{}-{}-run{}'.format(part, label, run))
+            args = ['--numClients={}'.format(options.numClients), '--RngRun={}'.format(run)] + variant_args
+            if any(a.startswith('--tcpVariant') for a in variant_args):
+                args.append('--cwndTrace={}.cwnd'.format(stem))
+                cwnd_files.append(stem + '.cwnd')
+            if options.cacheDir:
+                args.append('--cacheDir={}'.format(options.cacheDir))
+
+            print('Running {} run {}'.format(label, run), file=sys.stderr)
+            completions, retx, shares, simulation = parse_output(run_scenario(options.ns3, part, args, stem + '.txt'))
+            completion_times.extend(completions.values())
+            retransmissions.extend(retx.values())
+            incomplete += options.numClients - len(completions)
+            run_means.append(run_mean(completions, options.numClients, options.horizon))
+            if simulation:
+                simulations.append(simulation)
+            for client, time in completions.items():
+                per_client_times.setdefault(client, []).append(time)
+            for client, share in shares.items():
+                per_client_airtime.setdefault(client, []).append(share)
+
+        rows.append((label, completion_times, retransmissions, incomplete, cwnd_files,
+                     per_client_times, per_client_airtime, run_means, simulations))
+
+    print('{:<14} {:>9} {:>10} {:>10} {:>10} {:>12} {:>12} {:>10} {:>9}  {}'.format(
+        'variant', 'completed', 'mean (s)', 'median (s)', 'max (s)', 'retx/client', 'Mbps/client', 'events/s',
+        'wall (s)', 'cwnd traces'))
+    for label, times, retx, incomplete, cwnd_files, _, _, _, simulations in rows:
+        completed = '{}/{}'.format(len(times), len(times) + incomplete)
+        if times:
+            mean, median, worst = statistics.mean(times), statistics.median(times), max(times)
+        else:
+            mean = median = worst = float('nan')
+        retx_mean = statistics.mean(retx) if retx else float('nan')
+        events_rate = statistics.mean(s[0] for s in simulations) if simulations else float('nan')
+        throughput = statistics.mean(s[1] for s in simulations) if simulations else float('nan')
+        wall = statistics.mean(s[2] for s in simulations) if simulations else float('nan')
+        print('{:<14} {:>9} {:>10.2f} {:>10.2f} {:>10.2f} {:>12.1f} {:>12.2f} {:>10.0f} {:>9.2f}  {}'.format(
+            label, completed, mean, median, worst, retx_mean, throughput, events_rate, wall,
+            ' '.join(cwnd_files) or '-'))
+
+    if len(rows) > 1:
+        print_paired(rows)
+    if options.perClient and rows:
+        print_per_client(rows, options.numClients)
+
+
+if __name__ == '__main__':
+    main()
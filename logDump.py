@@ -0,0 +1,73 @@
+import argparse
+import re
+import struct
+
+# Formats the binary log ring the scenarios write with --logCategories/--logRing
+# (see scenario-log.h), oldest record first.
+#
+#   python3 logDump.py scenario-log.bin
+#   python3 logDump.py scenario-log.bin --category Mac --level Debug --tail 100
+
+levels = ['Error', 'Warn', 'Info', 'Debug', 'Trace']
+categories = ['Scenario', 'Mac', 'Phy', 'Tcp', 'Queue', 'App']
+specifier_pattern = re.compile(r'%[-+ #0]*\d*(?:\.\d+)?(?:hh|h|ll|l|z)?([diouxXeEfgGc])')
+record = struct.Struct('<qIHBB8s8s')
+
+
+def read_ring(path):
+    with open(path, 'rb') as f:
+        data = f.read()
+    if data[:8] != b'NS3LRING':
+        raise SystemExit('{} is not a scenario log ring'.format(path))
+    written, capacity, n_sites = struct.unpack_from('<QQI', data, 8)
+    offset = 28
+    sites = []
+    for _ in range(n_sites):
+        (length,) = struct.unpack_from('<H', data, offset)
+        sites.append(data[offset + 2:offset + 2 + length].decode())
+        offset += 2 + length
+    records = [record.unpack_from(data, o) for o in range(offset, len(data) - record.size + 1, record.size)]
+    return written, capacity, sites, records
+
+
+def format_message(fmt, raw_args):
+    # Arguments are stored as 64-bit slots; the specifier says how to read each
+    values = []
+    for kind, raw in zip((m.group(1) for m in specifier_pattern.finditer(fmt)), raw_args):
+        if kind in 'eEfgG':
+            values.append(struct.unpack('<d', raw)[0])
+        elif kind in 'di':
+            values.append(struct.unpack('<q', raw)[0])
+        else:
+            values.append(struct.unpack('<Q', raw)[0])
+    python_fmt = specifier_pattern.sub(lambda m: m.group(0).replace('ll', '').replace('l', '').replace('z', '')
+                                       .replace('hh', '').replace('h', ''), fmt)
+    return python_fmt % tuple(values) if values else fmt
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Print a scenario log ring')
+    parser.add_argument('ring')
+    parser.add_argument('--category', choices=categories, help='Only this category')
+    parser.add_argument('--level', choices=levels, help='Only this level and more severe')
+    parser.add_argument('--tail', type=int, help='Only the last N records')
+    options = parser.parse_args()
+
+    written, capacity, sites, records = read_ring(options.ring)
+    if written > capacity:
+        print('# ring wrapped: {} records logged, last {} kept'.format(written, capacity))
+    if options.tail:
+        records = records[-options.tail:]
+
+    for time_ns, node, site, category, level, a, b in records:
+        if options.category and categories[category] != options.category:
+            continue
+        if options.level and level > levels.index(options.level):
+            continue
+        node_text = '-' if node == 0xffffffff else str(node)
+        print('{:.9f} {:<5} {:<8} node {:>4} {}'.format(time_ns * 1e-9, levels[level], categories[category],
+                                                        node_text, format_message(sites[site], (a, b))))
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,194 @@
+import argparse
+import math
+
+# Merges completion-time summaries written by the scenarios' --summaryFile
+# option (one per run, seed or sweep point) without any per-client samples,
+# and prints the combined statistics or writes the combined ECDF.
+#
+#   python3 mergeSummaries.py runs/d-seed*.summary --ecdf d.ecdf
+
+
+class RunningStats:
+    def __init__(self, count=0, mean=0.0, m2=0.0, minimum=math.inf, maximum=-math.inf):
+        self.count, self.mean, self.m2, self.min, self.max = count, mean, m2, minimum, maximum
+
+    def merge(self, other):
+        if other.count == 0:
+            return
+        count = self.count + other.count
+        delta = other.mean - self.mean
+        self.m2 += other.m2 + delta * delta * self.count * other.count / count
+        self.mean += delta * other.count / count
+        self.count = count
+        self.min = min(self.min, other.min)
+        self.max = max(self.max, other.max)
+
+    def stddev(self):
+        return math.sqrt(self.m2 / (self.count - 1)) if self.count > 1 else 0.0
+
+
+class QuantileDigest:
+    # Same merging t-digest as streaming-stats.h
+    def __init__(self, compression=100.0):
+        self.compression = compression
+        self.centroids = []
+        self.min, self.max = math.inf, -math.inf
+
+    def k(self, q):
+        return self.compression / (2 * math.pi) * math.asin(2 * q - 1)
+
+    def k_inverse(self, k):
+        if k >= self.compression / 4:
+            return 1.0
+        return (math.sin(2 * math.pi * k / self.compression) + 1) / 2
+
+    def merge(self, other):
+        self.min, self.max = min(self.min, other.min), max(self.max, other.max)
+        points = sorted(self.centroids + other.centroids)
+        if not points:
+            return
+        total = sum(w for _, w in points)
+        merged = []
+        mean, weight = points[0]
+        so_far = 0.0
+        limit = total * self.k_inverse(self.k(0.0) + 1)
+        for m, w in points[1:]:
+            if so_far + weight + w <= limit:
+                weight += w
+                mean += (m - mean) * w / weight
+            else:
+                so_far += weight
+                merged.append((mean, weight))
+                limit = total * self.k_inverse(self.k(so_far / total) + 1)
+                mean, weight = m, w
+        merged.append((mean, weight))
+        self.centroids = merged
+
+    def quantile(self, q):
+        if not self.centroids:
+            return 0.0
+        total = sum(w for _, w in self.centroids)
+        target = q * total
+        cumulative, prev_center, prev_mean = 0.0, 0.0, self.min
+        for mean, weight in self.centroids:
+            center = cumulative + weight / 2
+            if target < center:
+                span = center - prev_center
+                return prev_mean + ((target - prev_center) / span if span > 0 else 0.0) * (mean - prev_mean)
+            cumulative += weight
+            prev_center, prev_mean = center, mean
+        span = total - prev_center
+        fraction = min(1.0, (target - prev_center) / span) if span > 0 else 1.0
+        return prev_mean + fraction * (self.max - prev_mean)
+
+    def ecdf(self):
+        if not self.centroids:
+            return []
+        total = sum(w for _, w in self.centroids)
+        points = [(self.min, 0.0)]
+        cumulative = 0.0
+        for mean, weight in self.centroids:
+            points.append((mean, (cumulative + weight / 2) / total))
+            cumulative += weight
+        points.append((self.max, 1.0))
+        return points
+
+
+class RateCounters:
+    # Rate-control counters of one direction, as in streaming-stats.h
+    SLOTS = 33
+
+    def __init__(self):
+        self.totals = [0] * 5  # normal, sampling, retries, intervals, changes
+        self.slots = [[0, 0, 0] for _ in range(self.SLOTS)]  # frames, airtime ns, best intervals
+
+    def merge(self, other):
+        self.totals = [a + b for a, b in zip(self.totals, other.totals)]
+        for mine, theirs in zip(self.slots, other.slots):
+            for i in range(3):
+                mine[i] += theirs[i]
+
+    def line(self):
+        normal, sampling, retries, intervals, changes = self.totals
+        first = normal + sampling
+        top = max(range(self.SLOTS), key=lambda slot: (self.slots[slot][2], -slot))
+        return 'frames {} sampling {:.2f} % retries {:.2f} % changes/interval {:.4f} top {} residency {:.2f} %'.format(
+            first, 100.0 * sampling / first if first else 0.0,
+            100.0 * retries / (first + retries) if first else 0.0,
+            changes / intervals if intervals else 0.0,
+            'nonHt' if top == self.SLOTS - 1 else top,
+            100.0 * self.slots[top][2] / intervals if intervals else 0.0)
+
+
+def load_summary(path):
+    stats = {}
+    rates = {'down': RateCounters(), 'up': RateCounters()}
+    incomplete = 0
+    digest = QuantileDigest()
+    with open(path) as f:
+        for line in f:
+            fields = line.split()
+            if not fields or fields[0].startswith('#'):
+                continue
+            if fields[0] in ('completion', 'throughput', 'jain'):
+                count, mean, m2, minimum, maximum = fields[1:6]
+                count = int(count)
+                stats[fields[0]] = RunningStats(count, float(mean), float(m2),
+                                                float(minimum) if count else math.inf,
+                                                float(maximum) if count else -math.inf)
+            elif fields[0] == 'incomplete':
+                incomplete = int(fields[1])
+            elif fields[0] == 'rate':
+                rates[fields[1]].totals = [int(value) for value in fields[2:7]]
+            elif fields[0] == 'rateMcs':
+                slot = int(fields[2])
+                rates[fields[1]].slots[slot] = [int(value) for value in fields[3:6]]
+            elif fields[0] == 'digest':
+                digest.compression = float(fields[1])
+                if int(fields[2]) > 0:
+                    digest.min, digest.max = float(fields[3]), float(fields[4])
+            elif fields[0] == 'centroid':
+                digest.centroids.append((float(fields[1]), float(fields[2])))
+    return stats, incomplete, rates, digest
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Merge completion-time summaries across runs and seeds')
+    parser.add_argument('summaries', nargs='+')
+    parser.add_argument('--ecdf', help='Write the merged ECDF (completion seconds, fraction) to this file')
+    options = parser.parse_args()
+
+    stats = {name: RunningStats() for name in ('completion', 'throughput', 'jain')}
+    incomplete = 0
+    rates = {'down': RateCounters(), 'up': RateCounters()}
+    digest = QuantileDigest()
+    for path in options.summaries:
+        file_stats, file_incomplete, file_rates, file_digest = load_summary(path)
+        incomplete += file_incomplete
+        for direction, counters in file_rates.items():
+            rates[direction].merge(counters)
+        for name, value in file_stats.items():
+            stats[name].merge(value)
+        digest.merge(file_digest)
+
+    completion = stats['completion']
+    # Incomplete clients are in the completion statistics at their run's end
+    print('Summary runs {} completed {} incomplete {} mean {:.4f} stddev {:.4f} p50 {:.4f} p90 {:.4f} p95 {:.4f} p99 {:.4f} max {:.4f} jain {:.4f}'.format(
+        stats['jain'].count, completion.count - incomplete, incomplete, completion.mean, completion.stddev(),
+        digest.quantile(0.50), digest.quantile(0.90), digest.quantile(0.95), digest.quantile(0.99),
+        completion.max if completion.count else 0.0, stats['jain'].mean))
+    print('Throughput per client mean {:.0f} bit/s stddev {:.0f} bit/s'.format(
+        stats['throughput'].mean, stats['throughput'].stddev()))
+    for direction in ('down', 'up'):
+        if sum(rates[direction].totals[:2]) > 0:
+            print('Summary rate {} {}'.format(direction, rates[direction].line()))
+
+    if options.ecdf:
+        with open(options.ecdf, 'w') as f:
+            f.write('# completionSeconds\tfraction\n')
+            for value, fraction in digest.ecdf():
+                f.write('{}\t{}\n'.format(value, fraction))
+
+
+if __name__ == '__main__':
+    main()